@@ -0,0 +1,19 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+
+// Shared by the headless benchmarks
+
+// best of a few runs, this box is noisy and a single pass can be off by 2x
+template<typename Fn>
+inline double bestOf(int runs, Fn fn) {
+    double best = 1e30;
+    for (int i = 0; i < runs; i++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count());
+    }
+    return best;
+}
@@ -0,0 +1,117 @@
+#include <core/flat_map.h>
+#include <core/utils.h>
+#include "bench_util.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+// Chunk map lookup benchmark, std::unordered_map vs the flat open addressing map, with the old and the chunk coordinate hash
+// usage: chunkmap_bench [loadDistance]
+
+
+struct Timings {
+    double insertNs, hitNs, neighbourNs, missNs;
+};
+
+// the same work for every map: fill it, random hits, the 6 neighbours of every chunk in load order (meshing), and misses
+template<typename Map>
+static Timings run(const std::vector<glm::ivec3>& keys, const std::vector<glm::ivec3>& shuffled, const std::vector<glm::ivec3>& missing, Map& map, long long& checksum) {
+    const int RUNS = 5;
+    const glm::ivec3 neighbours[6] = { {CHUNK_SIZE, 0, 0}, {-CHUNK_SIZE, 0, 0}, {0, CHUNK_SIZE, 0}, {0, -CHUNK_SIZE, 0}, {0, 0, CHUNK_SIZE}, {0, 0, -CHUNK_SIZE} };
+    Timings timings;
+    timings.insertNs = bestOf(RUNS, [&]{
+        map = Map();
+        for (size_t i = 0; i < keys.size(); i++) map[keys[i]] = static_cast<int>(i);
+    }) / keys.size() * 1e9;
+
+    long long sum = 0;
+    timings.hitNs = bestOf(RUNS, [&]{
+        for (const glm::ivec3& key : shuffled) sum += map.find(key)->second;
+    }) / shuffled.size() * 1e9;
+    timings.neighbourNs = bestOf(RUNS, [&]{
+        for (const glm::ivec3& key : keys) {
+            for (const glm::ivec3& offset : neighbours) {
+                auto it = map.find(key + offset);
+                sum += (it != map.end()) ? it->second : -1;
+            }
+        }
+    }) / (keys.size() * 6) * 1e9;
+    timings.missNs = bestOf(RUNS, [&]{
+        for (const glm::ivec3& key : missing) sum += map.count(key);
+    }) / missing.size() * 1e9;
+    checksum = sum;
+    return timings;
+}
+
+static void print(const std::string& name, const Timings& t) {
+    std::cout << name << "insert " << t.insertNs << " ns, hit " << t.hitNs << " ns, neighbours " << t.neighbourNs << " ns, miss " << t.missNs << " ns\n";
+}
+
+int main(int argc, char** argv) {
+    int loadDistance = argc > 1 ? std::atoi(argv[1]) : 46;
+    const int Y_LIMIT = 4;
+
+    // chunk origins of the game's load cylinder around the origin, in load order (nearest columns first)
+    std::vector<glm::ivec3> keys;
+    for (int x = -loadDistance; x <= loadDistance; x++) {
+        for (int z = -loadDistance; z <= loadDistance; z++) {
+            if (x * x + z * z > loadDistance * loadDistance) continue;
+            for (int y = -Y_LIMIT; y <= Y_LIMIT; y++) {
+                keys.push_back(glm::ivec3(x, y, z) * CHUNK_SIZE);
+            }
+        }
+    }
+    std::stable_sort(keys.begin(), keys.end(), [](const glm::ivec3& a, const glm::ivec3& b) {
+        return a.x * a.x + a.z * a.z < b.x * b.x + b.z * b.z;
+    });
+    std::vector<glm::ivec3> shuffled = keys;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(3));
+    std::vector<glm::ivec3> missing;
+    for (const glm::ivec3& key : shuffled) {
+        missing.push_back(key + glm::ivec3(0, (2 * Y_LIMIT + 1) * CHUNK_SIZE, 0)); // above the world
+    }
+
+    std::unordered_map<glm::ivec3, int> stdOld;
+    std::unordered_map<glm::ivec3, int, ChunkCoordHash> stdNew;
+    FlatMap<glm::ivec3, int, std::hash<glm::ivec3>> flatOld;
+    FlatMap<glm::ivec3, int, ChunkCoordHash> flatNew;
+    long long checksums[4];
+    Timings stdOldTimes = run(keys, shuffled, missing, stdOld, checksums[0]);
+    Timings stdNewTimes = run(keys, shuffled, missing, stdNew, checksums[1]);
+    Timings flatOldTimes = run(keys, shuffled, missing, flatOld, checksums[2]);
+    Timings flatNewTimes = run(keys, shuffled, missing, flatNew, checksums[3]);
+
+    // how the old hash spreads over unordered_map buckets
+    size_t longestChain = 0;
+    for (size_t b = 0; b < stdOld.bucket_count(); b++) {
+        longestChain = std::max(longestChain, stdOld.bucket_size(b));
+    }
+
+    // erase shifts entries back, every remaining key has to stay findable and every erased one gone
+    int mismatches = (checksums[1] != checksums[0]) + (checksums[2] != checksums[0]) + (checksums[3] != checksums[0]);
+    FlatMap<glm::ivec3, int, ChunkCoordHash> erased = flatNew;
+    for (size_t i = 0; i < shuffled.size(); i += 2) erased.erase(shuffled[i]);
+    for (size_t i = 0; i < shuffled.size(); i++) {
+        bool found = erased.count(shuffled[i]) > 0;
+        mismatches += (i % 2 == 0) ? found : !found;
+    }
+
+    auto oldStats = flatOld.getProbeStats();
+    auto newStats = flatNew.getProbeStats();
+    std::cout << "chunks:              " << keys.size() << " (load distance " << loadDistance << ")\n";
+    print("unordered, std::hash:  ", stdOldTimes);
+    print("unordered, chunk hash: ", stdNewTimes);
+    print("flat, std::hash:       ", flatOldTimes);
+    print("flat, chunk hash:      ", flatNewTimes);
+    std::cout << "std::hash buckets:   longest chain " << longestChain << " (load factor " << stdOld.load_factor() << ")\n";
+    std::cout << "flat probe lengths:  std::hash avg " << oldStats.averageProbe << " max " << oldStats.maxProbe
+              << ", chunk hash avg " << newStats.averageProbe << " max " << newStats.maxProbe << " (" << newStats.size << " in " << newStats.capacity << " slots)\n";
+    std::cout << "mismatches:          " << mismatches << "\n";
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+#include <world/world.h>
+#include "bench_util.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+
+// Chunk coordinate micro benchmark, getChunkOrigin and the getBlock hot path before and after shifts and masks
+// usage: coords_bench [lookups]
+
+
+// the float divide and floor getChunkOrigin used before, kept as the baseline
+static glm::ivec3 legacyChunkOrigin(glm::ivec3 blockPosition) {
+    return glm::ivec3(
+        floor(blockPosition.x / (float)CHUNK_SIZE) * CHUNK_SIZE,
+        floor(blockPosition.y / (float)CHUNK_SIZE) * CHUNK_SIZE,
+        floor(blockPosition.z / (float)CHUNK_SIZE) * CHUNK_SIZE
+    );
+}
+
+// and the getBlock built on it, with its local range check
+static const Block* legacyGetBlock(World& world, glm::ivec3 blockPosition) {
+    glm::ivec3 chunkCoord = legacyChunkOrigin(blockPosition);
+    const Chunk* chunk = world.getChunk(chunkCoord);
+    if (!chunk) {
+        return nullptr;
+    }
+    glm::ivec3 localPos = blockPosition - chunkCoord;
+    if (localPos.x < 0 || localPos.x >= CHUNK_SIZE ||
+        localPos.y < 0 || localPos.y >= CHUNK_SIZE ||
+        localPos.z < 0 || localPos.z >= CHUNK_SIZE) {
+        return nullptr;
+    }
+    return &chunk->blocks[localPos.x][localPos.y][localPos.z];
+}
+
+int main(int argc, char** argv) {
+    size_t lookups = argc > 1 ? std::atoi(argv[1]) : 4000000;
+    const int RUNS = 5;
+    const int COLUMNS_PER_SIDE = 4; // centred on 0, so half the lookups have negative x and z
+
+    World world;
+    world.initGenerator();
+    auto chunk = std::make_unique<Chunk>();
+    for (int cx = -COLUMNS_PER_SIDE / 2; cx < COLUMNS_PER_SIDE / 2; cx++) {
+        for (int cz = -COLUMNS_PER_SIDE / 2; cz < COLUMNS_PER_SIDE / 2; cz++) {
+            for (int y = -world.Y_LIMIT; y <= world.Y_LIMIT; y++) {
+                glm::ivec3 origin(cx * CHUNK_SIZE, y * CHUNK_SIZE, cz * CHUNK_SIZE);
+                *chunk = Chunk();
+                world.generateChunkBlocks(origin, *chunk);
+                world.addGeneratedChunk(origin, *chunk);
+            }
+        }
+    }
+
+    // short random walks like collision and raycasts do, mostly staying in a chunk and now and then crossing into the next
+    int half = COLUMNS_PER_SIDE / 2 * CHUNK_SIZE;
+    int height = (world.Y_LIMIT + 1) * CHUNK_SIZE;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> step(-1, 1);
+    std::vector<glm::ivec3> positions(lookups);
+    glm::ivec3 walker(0);
+    for (size_t i = 0; i < lookups; i++) {
+        if (i % 64 == 0) {
+            walker = glm::ivec3(rng() % (2 * half) - half, rng() % (2 * height) - height, rng() % (2 * half) - half);
+        }
+        walker += glm::ivec3(step(rng), step(rng), step(rng));
+        positions[i] = walker;
+    }
+
+    // both have to agree everywhere, negative coordinates and chunk edges included
+    int mismatches = 0;
+    for (int v = -3 * CHUNK_SIZE; v <= 3 * CHUNK_SIZE; v++) {
+        glm::ivec3 p(v, -v, v / 2);
+        mismatches += legacyChunkOrigin(p) != world.getChunkOrigin(p);
+    }
+    {
+        std::shared_lock<std::shared_mutex> lock(world.chunkMapMutex);
+        for (const glm::ivec3& p : positions) {
+            mismatches += legacyGetBlock(world, p) != world.getBlock(p);
+        }
+    }
+
+    volatile int sink = 0; // keeps the loops from being optimised away
+    double legacyOriginTime = bestOf(RUNS, [&]{
+        int sum = 0;
+        for (const glm::ivec3& p : positions) sum += legacyChunkOrigin(p).x + legacyChunkOrigin(p).z;
+        sink = sink + sum;
+    });
+    double originTime = bestOf(RUNS, [&]{
+        int sum = 0;
+        for (const glm::ivec3& p : positions) sum += world.getChunkOrigin(p).x + world.getChunkOrigin(p).z;
+        sink = sink + sum;
+    });
+
+    std::shared_lock<std::shared_mutex> lock(world.chunkMapMutex);
+    double legacyBlockTime = bestOf(RUNS, [&]{
+        int sum = 0;
+        for (const glm::ivec3& p : positions) {
+            const Block* block = legacyGetBlock(world, p);
+            sum += block ? block->type : 0;
+        }
+        sink = sink + sum;
+    });
+    double blockTime = bestOf(RUNS, [&]{
+        int sum = 0;
+        for (const glm::ivec3& p : positions) {
+            const Block* block = world.getBlock(p);
+            sum += block ? block->type : 0;
+        }
+        sink = sink + sum;
+    });
+
+    std::cout << "lookups:             " << lookups << "\n";
+    std::cout << "getChunkOrigin:      " << legacyOriginTime / lookups / 2 * 1e9 << " ns float floor, " << originTime / lookups / 2 * 1e9 << " ns shift/mask, "
+              << legacyOriginTime / originTime << "x\n";
+    std::cout << "getBlock:            " << legacyBlockTime / lookups * 1e9 << " ns float floor, " << blockTime / lookups * 1e9 << " ns shift/mask, "
+              << legacyBlockTime / blockTime << "x\n";
+    std::cout << "mismatches:          " << mismatches << "\n";
+
+    return mismatches == 0 ? 0 : 1;
+}
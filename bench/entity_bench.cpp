@@ -0,0 +1,137 @@
+#include <world/world.h>
+#include <entity/entity_store.h>
+#include <threadpool/threadpool.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+
+// Headless entity simulation benchmark, ticks/s for tens of thousands of walking entities on a generated world
+// usage: entity_bench [entities] [ticks]
+
+
+// spawns the same crowd every time: player sized walkers dropped onto the middle of the world, high enough to clear trees and overhangs
+static void spawnCrowd(World& world, EntityStore& entities, size_t count, int worldSize) {
+    entities.clear();
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> column(worldSize / 4, worldSize * 3 / 4);
+    for (size_t i = 0; i < count; i++) {
+        int x = column(rng), z = column(rng);
+        glm::vec3 position(x + unit(rng) * 0.4f, world.getTerrainHeight(x, z) + 16.0f + (unit(rng) + 1.0f) * 8.0f, z + unit(rng) * 0.4f);
+        glm::vec3 velocity(unit(rng) * 3.0f, 0.0f, unit(rng) * 3.0f);
+        entities.spawn(position, velocity, glm::vec3(0.6f, 1.8f, 0.6f));
+    }
+}
+
+// entities whose box overlaps a solid block, the voxel collision should keep this at zero
+static size_t countStuck(World& world, const EntityStore& entities) {
+    size_t stuck = 0;
+    std::shared_lock<std::shared_mutex> lock(world.chunkMapMutex);
+    for (size_t i = 0; i < entities.size(); i++) {
+        glm::vec3 min = entities.positions[i] - glm::vec3(entities.sizes[i].x / 2.0f, 0.0f, entities.sizes[i].z / 2.0f) + 0.01f;
+        glm::vec3 max = entities.positions[i] + glm::vec3(entities.sizes[i].x / 2.0f, entities.sizes[i].y, entities.sizes[i].z / 2.0f) - 0.01f;
+        bool inside = false;
+        for (int x = static_cast<int>(std::floor(min.x + 0.5f)); x <= static_cast<int>(std::floor(max.x + 0.5f)) && !inside; x++) {
+            for (int y = static_cast<int>(std::floor(min.y + 0.5f)); y <= static_cast<int>(std::floor(max.y + 0.5f)) && !inside; y++) {
+                for (int z = static_cast<int>(std::floor(min.z + 0.5f)); z <= static_cast<int>(std::floor(max.z + 0.5f)) && !inside; z++) {
+                    Block* block = world.getBlock(glm::ivec3(x, y, z));
+                    inside = block && block->type != 0;
+                }
+            }
+        }
+        stuck += inside;
+    }
+    return stuck;
+}
+
+// overlapping pairs by brute force, the spatial hash has to find every one of them
+static size_t bruteForceContacts(const EntityStore& entities) {
+    size_t contacts = 0;
+    for (size_t i = 0; i < entities.size(); i++) {
+        for (size_t j = i + 1; j < entities.size(); j++) {
+            glm::vec3 halfI = entities.sizes[i] * 0.5f, halfJ = entities.sizes[j] * 0.5f;
+            glm::vec3 centreI = entities.positions[i] + glm::vec3(0.0f, halfI.y, 0.0f);
+            glm::vec3 centreJ = entities.positions[j] + glm::vec3(0.0f, halfJ.y, 0.0f);
+            glm::vec3 overlap = halfI + halfJ - glm::abs(centreI - centreJ);
+            contacts += overlap.x > 0.0f && overlap.y > 0.0f && overlap.z > 0.0f;
+        }
+    }
+    return contacts;
+}
+
+int main(int argc, char** argv) {
+    size_t entityCount = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int ticks = argc > 2 ? std::atoi(argv[2]) : 300;
+    const float TICK = 1.0f / 60.0f;
+    const int COLUMNS_PER_SIDE = 8;
+
+    World world;
+    world.initGenerator();
+    auto chunk = std::make_unique<Chunk>();
+    for (int cx = 0; cx < COLUMNS_PER_SIDE; cx++) {
+        for (int cz = 0; cz < COLUMNS_PER_SIDE; cz++) {
+            for (int y = -world.Y_LIMIT; y <= world.Y_LIMIT; y++) {
+                glm::ivec3 origin(cx * CHUNK_SIZE, y * CHUNK_SIZE, cz * CHUNK_SIZE);
+                *chunk = Chunk();
+                world.generateChunkBlocks(origin, *chunk);
+                world.addGeneratedChunk(origin, *chunk);
+            }
+        }
+    }
+    int worldSize = COLUMNS_PER_SIDE * CHUNK_SIZE;
+
+    // the spatial hash against brute force on a smaller crowd, first tick (everyone still where they spawned) and after walking a while
+    EntityStore check;
+    spawnCrowd(world, check, std::min<size_t>(entityCount, 4000), worldSize);
+    size_t missedContacts = 0;
+    for (int tick = 0; tick < 60; tick++) {
+        size_t expected = bruteForceContacts(check);
+        check.update(world, nullptr, TICK);
+        missedContacts += expected - std::min(expected, check.getContacts());
+        if (check.getContacts() != expected) {
+            std::cout << "tick " << tick << ": spatial hash found " << check.getContacts() << " contacts, brute force " << expected << "\n";
+        }
+    }
+
+    EntityStore entities;
+    auto runTicks = [&](Threadpool* threadpool, double& broadphaseMs, double& integrateMs, size_t& pairTests) {
+        spawnCrowd(world, entities, entityCount, worldSize);
+        broadphaseMs = integrateMs = 0.0;
+        pairTests = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int tick = 0; tick < ticks; tick++) {
+            entities.update(world, threadpool, TICK);
+            broadphaseMs += entities.getBroadphaseMs();
+            integrateMs += entities.getIntegrateMs();
+            pairTests += entities.getPairTests();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    };
+
+    double serialBroadphase, serialIntegrate, pooledBroadphase, pooledIntegrate;
+    size_t serialPairs, pooledPairs;
+    double serialMs = runTicks(nullptr, serialBroadphase, serialIntegrate, serialPairs);
+
+    Threadpool threadpool;
+    threadpool.init();
+    double pooledMs = runTicks(&threadpool, pooledBroadphase, pooledIntegrate, pooledPairs);
+    threadpool.cleanup();
+    size_t stuck = countStuck(world, entities);
+
+    double naivePairs = static_cast<double>(entityCount) * (entityCount - 1);
+    std::cout << "entities:            " << entityCount << ", " << ticks << " ticks\n";
+    std::cout << "this thread:         " << serialMs / ticks << " ms/tick (broadphase " << serialBroadphase / ticks << ", movement " << serialIntegrate / ticks << ")\n";
+    std::cout << "threadpool:          " << pooledMs / ticks << " ms/tick (broadphase " << pooledBroadphase / ticks << ", movement " << pooledIntegrate / ticks << "), "
+              << std::thread::hardware_concurrency() << " hardware threads\n";
+    std::cout << "entity updates/s:    " << entityCount * ticks / (pooledMs / 1000.0) / 1e6 << " M\n";
+    std::cout << "pair tests per tick: " << pooledPairs / ticks << " (" << 100.0 * (pooledPairs / ticks) / naivePairs << "% of all pairs)\n";
+    std::cout << "contacts last tick:  " << entities.getContacts() << "\n";
+    std::cout << "missed contacts:     " << missedContacts << "\n";
+    std::cout << "stuck in blocks:     " << stuck << "\n";
+
+    return (missedContacts == 0 && stuck == 0) ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+#include <world/world.h>
+#include <physics/raycast.h>
+#include <threadpool/threadpool.h>
+#include "bench_util.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+
+// Headless block raycast benchmark, rays/s on a generated world
+// usage: raycast_bench [columnsPerSide] [rays]
+// without arguments it runs 40x40 and 24x24 columns: the chunk sort in the batch only pays off once the
+// chunks the rays touch dont fit in cache, on the small world the batch is slower than a lock per ray
+
+
+// The fixed step march the player ray used before the DDA (one ray, no thickening), kept as the baseline
+static glm::ivec3 fixedStepRay(World& world, const Ray& ray) {
+    glm::vec3 direction = glm::normalize(ray.direction);
+    glm::ivec3 previous = glm::ivec3(INT_MAX);
+    for (float t = 0.1f; t < ray.maxDistance; t += 0.1f) {
+        glm::ivec3 blockPosition = glm::ivec3(glm::round(ray.origin + direction * t));
+        if (blockPosition == previous) continue;
+        previous = blockPosition;
+        std::shared_lock<std::shared_mutex> lock(world.chunkMapMutex);
+        Block* block = world.getBlock(blockPosition);
+        if (block && block->type != 0) {
+            return blockPosition;
+        }
+    }
+    return glm::ivec3(INT_MAX);
+}
+
+// returns the number of rays where the paths disagree
+static int runBench(int columnsPerSide, size_t rayCount) {
+    const int RUNS = 5;
+    const float REACH = 64.0f;
+
+    World world;
+    world.initGenerator();
+    auto chunk = std::make_unique<Chunk>();
+    for (int cx = 0; cx < columnsPerSide; cx++) {
+        for (int cz = 0; cz < columnsPerSide; cz++) {
+            for (int y = -world.Y_LIMIT; y <= world.Y_LIMIT; y++) {
+                glm::ivec3 origin(cx * CHUNK_SIZE, y * CHUNK_SIZE, cz * CHUNK_SIZE);
+                *chunk = Chunk();
+                world.generateChunkBlocks(origin, *chunk);
+                world.addGeneratedChunk(origin, *chunk);
+            }
+        }
+    }
+
+    // rays from a few blocks above the surface, mostly looking down and sideways like NPCs and explosions would
+    int worldSize = columnsPerSide * CHUNK_SIZE;
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> column(0, worldSize - 1);
+    std::vector<Ray> rays(rayCount);
+    for (Ray& ray : rays) {
+        int x = column(rng), z = column(rng);
+        ray.origin = glm::vec3(x + unit(rng) * 0.5f, world.getTerrainHeight(x, z) + 2.0f + (unit(rng) + 1.0f) * 4.0f, z + unit(rng) * 0.5f);
+        ray.direction = glm::vec3(unit(rng), unit(rng) - 0.3f, unit(rng));
+        ray.maxDistance = REACH;
+    }
+
+    std::vector<RaycastHit> singleHits(rayCount), batchHits(rayCount), pooledHits(rayCount);
+    size_t legacyCount = std::min<size_t>(rayCount, 20000); // the march is slow, time a slice of it
+    std::vector<glm::ivec3> legacyHits(legacyCount);
+
+    double legacyTime = bestOf(RUNS, [&]{
+        for (size_t i = 0; i < legacyCount; i++) legacyHits[i] = fixedStepRay(world, rays[i]);
+    });
+    double singleTime = bestOf(RUNS, [&]{
+        for (size_t i = 0; i < rayCount; i++) singleHits[i] = raycastBlocks(world, rays[i].origin, rays[i].direction, rays[i].maxDistance);
+    });
+    double batchTime = bestOf(RUNS, [&]{
+        raycastBlocksBatch(world, rays.data(), rayCount, batchHits.data(), nullptr);
+    });
+
+    Threadpool threadpool;
+    threadpool.init();
+    double pooledTime = bestOf(RUNS, [&]{
+        raycastBlocksBatch(world, rays.data(), rayCount, pooledHits.data(), &threadpool);
+    });
+    threadpool.cleanup();
+
+    // every path has to agree on what was hit
+    int mismatches = 0, hits = 0;
+    for (size_t i = 0; i < rayCount; i++) {
+        hits += singleHits[i].hit;
+        if (batchHits[i].block != singleHits[i].block || batchHits[i].previous != singleHits[i].previous ||
+            pooledHits[i].block != singleHits[i].block || pooledHits[i].previous != singleHits[i].previous) {
+            mismatches++;
+        }
+    }
+    int legacyMisses = 0; // hits the fixed step skipped or reported a corner late on
+    for (size_t i = 0; i < legacyCount; i++) {
+        legacyMisses += legacyHits[i] != singleHits[i].block;
+    }
+
+    std::cout << "world:               " << columnsPerSide << "x" << columnsPerSide << " columns\n";
+    std::cout << "rays:                " << rayCount << " (" << 100.0 * hits / rayCount << "% hit within " << REACH << " blocks)\n";
+    std::cout << "fixed step march:    " << legacyCount / legacyTime / 1e6 << " Mrays/s, differs from DDA on " << 100.0 * legacyMisses / legacyCount << "% of rays\n";
+    std::cout << "DDA, lock per ray:   " << rayCount / singleTime / 1e6 << " Mrays/s\n";
+    std::cout << "batch, this thread:  " << rayCount / batchTime / 1e6 << " Mrays/s\n";
+    std::cout << "batch, threadpool:   " << rayCount / pooledTime / 1e6 << " Mrays/s (" << std::thread::hardware_concurrency() << " hardware threads)\n";
+    std::cout << "mismatched hits:     " << mismatches << "\n";
+
+    return mismatches;
+}
+
+int main(int argc, char** argv) {
+    size_t rayCount = argc > 2 ? std::atoi(argv[2]) : 500000;
+    if (argc > 1) {
+        return runBench(std::atoi(argv[1]), rayCount) == 0 ? 0 : 1;
+    }
+
+    int mismatches = runBench(40, rayCount);
+    std::cout << "\n";
+    mismatches += runBench(24, rayCount);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+#include <world/world.h>
+#include "bench_util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+
+// Headless terrain generation benchmark
+// usage: worldgen_bench [columnsPerSide]
+
+
+// The per-block branching fill generateChunkData used before column spans, kept as the baseline
+// (block types still come from the biome of each column)
+static void legacyFill(World& world, glm::ivec3 chunkOrigin, const ColumnHeightmap& heightmap, int yLimit, Chunk& chunk) {
+    u_int8_t surfaceBlocks[CHUNK_SIZE][CHUNK_SIZE];
+    u_int8_t subsurfaceBlocks[CHUNK_SIZE][CHUNK_SIZE];
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            ColumnSpans spans = world.calculateColumnSpans(chunkOrigin.y, heightmap.heights[x][z], heightmap.biomes[x][z]);
+            surfaceBlocks[x][z] = spans.surfaceBlock;
+            subsurfaceBlocks[x][z] = spans.subsurfaceBlock;
+        }
+    }
+
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            int globalY = chunkOrigin.y + y;
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                int height = heightmap.heights[x][z];
+
+                if (globalY > height) {
+                    chunk.blocks[x][y][z].type = 0; // Air
+                } else if (globalY == height) {
+                    chunk.blocks[x][y][z].type = surfaceBlocks[x][z];
+                } else if (globalY >= height - 5) {
+                    chunk.blocks[x][y][z].type = subsurfaceBlocks[x][z];
+                } else if (globalY >= -(yLimit*CHUNK_SIZE)) {
+                    chunk.blocks[x][y][z].type = 3; // Stone
+                }
+            }
+        }
+    }
+}
+
+static long long countSolid(const Chunk& chunk) {
+    long long count = 0;
+    const Block* blocks = &chunk.blocks[0][0][0];
+    for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE; i++) {
+        count += blocks[i].type != 0;
+    }
+    return count;
+}
+
+int main(int argc, char** argv) {
+    int columnsPerSide = argc > 1 ? std::atoi(argv[1]) : 24;
+    const int RUNS = 5;
+
+    World world;
+    world.initGenerator();
+
+    // chunk origins of a square of columns, every vertical chunk of each column
+    std::vector<glm::ivec3> chunkOrigins;
+    for (int cx = 0; cx < columnsPerSide; cx++) {
+        for (int cz = 0; cz < columnsPerSide; cz++) {
+            for (int y = -world.Y_LIMIT; y <= world.Y_LIMIT; y++) {
+                chunkOrigins.push_back(glm::ivec3(cx * CHUNK_SIZE, y * CHUNK_SIZE, cz * CHUNK_SIZE));
+            }
+        }
+    }
+    double blockCount = static_cast<double>(chunkOrigins.size()) * CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+    auto chunk = std::make_unique<Chunk>();
+    auto reference = std::make_unique<Chunk>();
+
+    // Cold: heightmap noise + fill + caves, initGenerator() empties the heightmap and biome caches before every run
+    double coldTime = bestOf(RUNS, [&]{
+        world.initGenerator();
+        for (const auto& origin : chunkOrigins) {
+            *chunk = Chunk();
+            world.generateChunkBlocks(origin, *chunk);
+        }
+    });
+
+    // Biome lookup on its own (fresh map so its region cache is cold too), it has to stay a small slice of generation
+    BiomeSample biomeSamples[CHUNK_SIZE][CHUNK_SIZE];
+    double biomeTime = bestOf(RUNS, [&]{
+        BiomeMap biomeMap;
+        biomeMap.init(world.getNoiseSeed());
+        for (int cx = 0; cx < columnsPerSide; cx++) {
+            for (int cz = 0; cz < columnsPerSide; cz++) {
+                biomeMap.sampleColumn(cx * CHUNK_SIZE, cz * CHUNK_SIZE, biomeSamples);
+            }
+        }
+    });
+
+    // Heightmaps are held from here on, so the fills are compared on block writes alone
+    std::vector<std::shared_ptr<const ColumnHeightmap>> heightmaps;
+    for (const auto& origin : chunkOrigins) {
+        heightmaps.push_back(world.getColumnHeightmap(origin.x, origin.z));
+    }
+
+    double legacyTime = bestOf(RUNS, [&]{
+        for (size_t i = 0; i < chunkOrigins.size(); i++) {
+            *reference = Chunk();
+            legacyFill(world, chunkOrigins[i], *heightmaps[i], world.Y_LIMIT, *reference);
+        }
+    });
+
+    double spanTime = bestOf(RUNS, [&]{
+        for (size_t i = 0; i < chunkOrigins.size(); i++) {
+            *chunk = Chunk();
+            world.fillChunkBlocks(chunkOrigins[i], *heightmaps[i], *chunk);
+        }
+    });
+
+    // Caves, the cost is whatever carving adds on top of the span fill
+    double spanAndCaveTime = bestOf(RUNS, [&]{
+        for (size_t i = 0; i < chunkOrigins.size(); i++) {
+            *chunk = Chunk();
+            world.fillChunkBlocks(chunkOrigins[i], *heightmaps[i], *chunk);
+            world.carveCaves(chunkOrigins[i], *heightmaps[i], *chunk);
+        }
+    });
+    double caveTime = std::max(spanAndCaveTime - spanTime, 0.0);
+
+    // both fills must produce identical chunks, and count what the caves carved out
+    int mismatches = 0;
+    long long solidBefore = 0, solidAfter = 0;
+    for (size_t i = 0; i < chunkOrigins.size(); i++) {
+        *reference = Chunk();
+        *chunk = Chunk();
+        legacyFill(world, chunkOrigins[i], *heightmaps[i], world.Y_LIMIT, *reference);
+        world.fillChunkBlocks(chunkOrigins[i], *heightmaps[i], *chunk);
+        if (memcmp(reference->blocks, chunk->blocks, sizeof(chunk->blocks)) != 0) {
+            mismatches++;
+        }
+
+        solidBefore += countSolid(*chunk);
+        world.carveCaves(chunkOrigins[i], *heightmaps[i], *chunk);
+        solidAfter += countSolid(*chunk);
+    }
+
+    std::cout << "chunks:              " << chunkOrigins.size() << "\n";
+    std::cout << "cold generation:     " << coldTime * 1000.0 << " ms, " << blockCount / coldTime / 1e6 << " Mblocks/s\n";
+    std::cout << "biome lookup:        " << biomeTime * 1000.0 << " ms, " << biomeTime / coldTime * 100.0 << "% of cold generation\n";
+    std::cout << "cave carving:        " << caveTime * 1000.0 << " ms, " << caveTime / coldTime * 100.0 << "% of cold generation, "
+              << 100.0 * (solidBefore - solidAfter) / solidBefore << "% of solid blocks carved\n";
+    std::cout << "legacy per-block:    " << legacyTime * 1000.0 << " ms, " << blockCount / legacyTime / 1e6 << " Mblocks/s\n";
+    std::cout << "column spans:        " << spanTime * 1000.0 << " ms, " << blockCount / spanTime / 1e6 << " Mblocks/s\n";
+    std::cout << "speedup:             " << legacyTime / spanTime << "x\n";
+    std::cout << "mismatched chunks:   " << mismatches << "\n";
+
+    return mismatches == 0 ? 0 : 1;
+}
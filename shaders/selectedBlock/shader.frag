@@ -30,6 +30,18 @@ void main()
     }
     else if (blockType == 3.0){ //Stone
         atlasPos = vec2(7.0f, 0.0f);
+    }
+    else if (blockType == 4.0){ //Sand
+        atlasPos = vec2(6.0f, 0.0f);
+    }
+    else if (blockType == 5.0){ //Snow
+        if (FaceID == 2.0) {
+            atlasPos = vec2(4.0, 0.0); // Top
+        } else if (FaceID == 3.0) {
+            atlasPos = vec2(2.0, 0.0); // Bottom (dirt)
+        } else {
+            atlasPos = vec2(3.0, 0.0); // Sides
+        }
     }    
 
     // we are working with normalised values here    
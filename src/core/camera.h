@@ -18,6 +18,15 @@ struct Camera {
     const float sensitivity = 0.1f;
     const float maxPitch = 89.0f;
 
+    // recompute front from yaw and pitch (degrees)
+    void updateFront() {
+        glm::vec3 direction;
+        direction.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+        direction.y = sin(glm::radians(pitch));
+        direction.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+        front = glm::normalize(direction);
+    }
+
     // Method to be moved from global scope
     glm::mat4 getViewMatrix() {
         return glm::lookAt(position, position + front, up);
@@ -6,6 +6,9 @@ constexpr int SCREEN_WIDTH = 800;
 constexpr int SCREEN_HEIGHT = 600;
 constexpr float BLOCK_SIZE = 1.0f; 
 constexpr int CHUNK_SIZE = 32;
+constexpr int CHUNK_SHIFT = 5;              // log2(CHUNK_SIZE)
+constexpr int CHUNK_MASK = CHUNK_SIZE - 1;
+static_assert(CHUNK_SIZE == 1 << CHUNK_SHIFT, "chunk coordinate math uses shifts and masks");
 
 // face coords
 inline constexpr float rightFace[] = {
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <sys/types.h>
+
+
+// Open addressing hash map with linear probing, keys and values live in one flat array instead of one heap node each.
+// Kept at most half full so probes stay short, erase shifts the following entries back instead of leaving tombstones.
+// Only the subset of the std::unordered_map interface the world uses. Like it, inserting can move every entry,
+// so iterators and references are invalidated by operator[] (store big values behind a unique_ptr).
+// Unlike it, erase moves a later entry back into the freed slot, so erasing while iterating skips entries (collect the keys first)
+template<typename Key, typename Value, typename Hash>
+class FlatMap {
+    public:
+        struct Slot {
+            Key first{};
+            Value second{};
+        };
+
+        // average and longest number of slots a successful find looks at, 1 is a hit in the home slot
+        struct ProbeStats {
+            size_t size = 0;
+            size_t capacity = 0;
+            double averageProbe = 0.0;
+            size_t maxProbe = 0;
+        };
+
+        template<bool IS_CONST>
+        class Iterator {
+            public:
+                using MapPtr = std::conditional_t<IS_CONST, const FlatMap*, FlatMap*>;
+                using SlotRef = std::conditional_t<IS_CONST, const Slot&, Slot&>;
+                using SlotPtr = std::conditional_t<IS_CONST, const Slot*, Slot*>;
+
+                Iterator(MapPtr map, size_t index) : m_map(map), m_index(index) { skipEmpty(); }
+                SlotRef operator*() const { return m_map->m_slots[m_index]; }
+                SlotPtr operator->() const { return &m_map->m_slots[m_index]; }
+                Iterator& operator++() { m_index++; skipEmpty(); return *this; }
+                bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+                bool operator!=(const Iterator& other) const { return m_index != other.m_index; }
+
+            private:
+                MapPtr m_map;
+                size_t m_index;
+
+                void skipEmpty() {
+                    while (m_index < m_map->m_used.size() && !m_map->m_used[m_index]) {
+                        m_index++;
+                    }
+                }
+        };
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, m_used.size()); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, m_used.size()); }
+
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        size_t capacity() const { return m_slots.size(); }
+
+        iterator find(const Key& key) {
+            size_t index = findIndex(key);
+            return iterator(this, index == NOT_FOUND ? m_used.size() : index);
+        }
+        const_iterator find(const Key& key) const {
+            size_t index = findIndex(key);
+            return const_iterator(this, index == NOT_FOUND ? m_used.size() : index);
+        }
+        size_t count(const Key& key) const { return findIndex(key) != NOT_FOUND; }
+
+        Value& at(const Key& key) {
+            size_t index = findIndex(key);
+            if (index == NOT_FOUND) {
+                throw std::out_of_range("FlatMap::at");
+            }
+            return m_slots[index].second;
+        }
+
+        // inserts a default value if the key isnt there
+        Value& operator[](const Key& key) {
+            size_t index = findIndex(key);
+            if (index != NOT_FOUND) {
+                return m_slots[index].second;
+            }
+            if ((m_size + 1) * 2 > m_slots.size()) {
+                rehash(m_slots.empty() ? MIN_CAPACITY : m_slots.size() * 2);
+            }
+            index = home(key);
+            while (m_used[index]) {
+                index = (index + 1) & m_mask;
+            }
+            m_used[index] = 1;
+            m_slots[index].first = key;
+            m_size++;
+            return m_slots[index].second;
+        }
+
+        bool erase(const Key& key) {
+            size_t hole = findIndex(key);
+            if (hole == NOT_FOUND) {
+                return false;
+            }
+            // pull back every following entry of the run that would still be found from its home slot in the hole
+            size_t next = (hole + 1) & m_mask;
+            while (m_used[next]) {
+                size_t nextHome = home(m_slots[next].first);
+                if (((next - nextHome) & m_mask) >= ((next - hole) & m_mask)) {
+                    m_slots[hole] = std::move(m_slots[next]);
+                    hole = next;
+                }
+                next = (next + 1) & m_mask;
+            }
+            m_slots[hole] = Slot{};
+            m_used[hole] = 0;
+            m_size--;
+            return true;
+        }
+
+        void clear() {
+            m_slots.clear();
+            m_used.clear();
+            m_size = 0;
+            m_mask = 0;
+        }
+
+        void reserve(size_t count) {
+            size_t capacity = MIN_CAPACITY;
+            while (capacity < count * 2) {
+                capacity *= 2;
+            }
+            if (capacity > m_slots.size()) {
+                rehash(capacity);
+            }
+        }
+
+        // walks the whole table, for debug views and benchmarks
+        ProbeStats getProbeStats() const {
+            ProbeStats stats;
+            stats.size = m_size;
+            stats.capacity = m_slots.size();
+            size_t total = 0;
+            for (size_t i = 0; i < m_slots.size(); i++) {
+                if (m_used[i]) {
+                    size_t probe = ((i - home(m_slots[i].first)) & m_mask) + 1;
+                    total += probe;
+                    stats.maxProbe = std::max(stats.maxProbe, probe);
+                }
+            }
+            stats.averageProbe = m_size > 0 ? static_cast<double>(total) / m_size : 0.0;
+            return stats;
+        }
+
+    private:
+        static constexpr size_t MIN_CAPACITY = 16;
+        static constexpr size_t NOT_FOUND = ~size_t(0);
+
+        std::vector<Slot> m_slots;
+        std::vector<u_int8_t> m_used;
+        size_t m_size = 0;
+        size_t m_mask = 0;
+
+        size_t home(const Key& key) const { return Hash()(key) & m_mask; }
+
+        size_t findIndex(const Key& key) const {
+            if (m_size == 0) {
+                return NOT_FOUND;
+            }
+            size_t index = home(key);
+            while (m_used[index]) {
+                if (m_slots[index].first == key) {
+                    return index;
+                }
+                index = (index + 1) & m_mask;
+            }
+            return NOT_FOUND;
+        }
+
+        void rehash(size_t capacity) {
+            std::vector<Slot> oldSlots = std::move(m_slots);
+            std::vector<u_int8_t> oldUsed = std::move(m_used);
+            m_slots = std::vector<Slot>(capacity);
+            m_used.assign(capacity, 0);
+            m_mask = capacity - 1;
+            for (size_t i = 0; i < oldSlots.size(); i++) {
+                if (oldUsed[i]) {
+                    size_t index = home(oldSlots[i].first);
+                    while (m_used[index]) {
+                        index = (index + 1) & m_mask;
+                    }
+                    m_used[index] = 1;
+                    m_slots[index] = std::move(oldSlots[i]);
+                }
+            }
+        }
+};
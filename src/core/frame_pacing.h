@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+
+// Adaptive main thread upload budget
+// the time left in a frame after the rest of the update and render work goes to main thread tasks (mesh uploads),
+// so uploads get more room at high fps and stop adding hitches once frames run long.
+// The time budget is also turned into a byte budget from the measured upload rate, so one big mesh
+// cant blow through the end of the budget the way a time check after each task would let it
+class FramePacing {
+    public:
+        void setTargetFrameMs(float ms) { m_targetMs = ms; }
+
+        // once per frame: the time spent outside main thread tasks, and what those tasks did
+        void endFrame(float workMs, double uploadMs, size_t uploadBytes) {
+            m_workMs += (workMs - m_workMs) * WORK_SMOOTHING;
+            // tiny uploads are mostly call overhead and would skew the rate
+            if (uploadBytes > 0 && uploadMs > 0.05) {
+                m_bytesPerMs += (uploadBytes / uploadMs - m_bytesPerMs) * RATE_SMOOTHING;
+            }
+            m_lastUploadMs = uploadMs;
+            m_lastUploadBytes = uploadBytes;
+        }
+
+        double getUploadBudgetMs() const {
+            return std::clamp(static_cast<double>(m_targetMs - m_workMs - SAFETY_MARGIN_MS), MIN_BUDGET_MS, MAX_BUDGET_MS);
+        }
+        size_t getUploadBudgetBytes() const { return static_cast<size_t>(getUploadBudgetMs() * m_bytesPerMs); }
+
+        float getTargetFrameMs() const { return m_targetMs; }
+        double getLastUploadMs() const { return m_lastUploadMs; }
+        size_t getLastUploadBytes() const { return m_lastUploadBytes; }
+        double getUploadBytesPerMs() const { return m_bytesPerMs; }
+
+    private:
+        static constexpr float WORK_SMOOTHING = 0.1f;
+        static constexpr double RATE_SMOOTHING = 0.2;
+        static constexpr float SAFETY_MARGIN_MS = 1.0f; // driver and swap jitter
+        static constexpr double MIN_BUDGET_MS = 0.5;    // uploads always make some progress
+        static constexpr double MAX_BUDGET_MS = 8.0;
+
+        float m_targetMs = 1000.0f / 60.0f;
+        float m_workMs = 0.0f;
+        double m_bytesPerMs = 256.0 * 1024.0; // first guess until uploads have been measured
+        double m_lastUploadMs = 0.0;
+        size_t m_lastUploadBytes = 0;
+};
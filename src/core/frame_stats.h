@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+
+
+// main thread subsystems timed every frame
+enum class SUBSYSTEM: int {
+    INPUT = 0,
+    PHYSICS,
+    RAYCAST,
+    UPLOADS,
+    CULLING,
+    DRAW,
+    COUNT
+};
+inline const char* subsystemNames[static_cast<int>(SUBSYSTEM::COUNT)] = { "Input", "Physics", "Raycast", "Uploads", "Culling", "Draw" };
+
+
+// Rolling frame time statistics over the last WINDOW frames: histogram, percentiles, hitches and per subsystem times
+// average fps hides stutter, a single 80 ms frame in a second of 16 ms frames barely moves it but shows up here
+class FrameStats {
+    public:
+        static constexpr int WINDOW = 1024;
+        static constexpr int HISTOGRAM_BINS = 50;
+        static constexpr float HISTOGRAM_BIN_MS = 1.0f;  // the last bin also holds everything slower
+        static constexpr int HITCH_THRESHOLDS = 3;
+
+        float hitchThresholdsMs[HITCH_THRESHOLDS] = { 33.3f, 50.0f, 100.0f }; // frames slower than these count as hitches
+
+        // subsystem times of the frame in progress, in ms
+        void addTime(SUBSYSTEM subsystem, float ms) { m_current[static_cast<int>(subsystem)] += ms; }
+
+        void endFrame(float frameMs) {
+            // drop the frame falling out of the window from the histogram
+            if (m_frameCount == WINDOW) {
+                m_histogram[binOf(m_frameTimes[m_frameIndex])]--;
+            }
+            m_frameTimes[m_frameIndex] = frameMs;
+            m_histogram[binOf(frameMs)]++;
+            for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+                m_subsystemTimes[i][m_frameIndex] = m_current[i];
+                m_current[i] = 0.0f;
+            }
+            for (int i = 0; i < HITCH_THRESHOLDS; i++) {
+                if (frameMs > hitchThresholdsMs[i]) {
+                    m_sessionHitches[i]++;
+                }
+            }
+            m_frameIndex = (m_frameIndex + 1) % WINDOW;
+            m_frameCount = std::min(m_frameCount + 1, WINDOW);
+
+            // percentiles over a copy, nth_element reorders it
+            std::copy(m_frameTimes, m_frameTimes + m_frameCount, m_sorted);
+            m_p50 = percentile(0.50f);
+            m_p95 = percentile(0.95f);
+            m_p99 = percentile(0.99f);
+            m_max = *std::max_element(m_frameTimes, m_frameTimes + m_frameCount);
+        }
+
+        void resetHitches() {
+            std::fill(m_sessionHitches, m_sessionHitches + HITCH_THRESHOLDS, 0);
+        }
+
+        float getP50() const { return m_p50; }
+        float getP95() const { return m_p95; }
+        float getP99() const { return m_p99; }
+        float getMax() const { return m_max; }
+        int getFrameCount() const { return m_frameCount; }
+        const float* getHistogram() const { return m_histogram; }
+
+        // frames over a threshold, in the window and since the last reset
+        int getWindowHitches(int threshold) const {
+            return static_cast<int>(std::count_if(m_frameTimes, m_frameTimes + m_frameCount,
+                                                  [&](float ms) { return ms > hitchThresholdsMs[threshold]; }));
+        }
+        int getSessionHitches(int threshold) const { return m_sessionHitches[threshold]; }
+
+        float getSubsystemAverage(SUBSYSTEM subsystem) const {
+            const float* times = m_subsystemTimes[static_cast<int>(subsystem)];
+            float sum = 0.0f;
+            for (int i = 0; i < m_frameCount; i++) {
+                sum += times[i];
+            }
+            return m_frameCount > 0 ? sum / m_frameCount : 0.0f;
+        }
+        float getLastSubsystemTime(SUBSYSTEM subsystem) const {
+            return m_subsystemTimes[static_cast<int>(subsystem)][(m_frameIndex + WINDOW - 1) % WINDOW];
+        }
+        float getSubsystemMax(SUBSYSTEM subsystem) const {
+            const float* times = m_subsystemTimes[static_cast<int>(subsystem)];
+            return m_frameCount > 0 ? *std::max_element(times, times + m_frameCount) : 0.0f;
+        }
+
+    private:
+        static constexpr int SUBSYSTEM_COUNT = static_cast<int>(SUBSYSTEM::COUNT);
+
+        float m_frameTimes[WINDOW] = {0};
+        float m_sorted[WINDOW] = {0};
+        float m_subsystemTimes[SUBSYSTEM_COUNT][WINDOW] = {};
+        float m_current[SUBSYSTEM_COUNT] = {0};
+        float m_histogram[HISTOGRAM_BINS] = {0}; // float so ImGui can plot it directly
+        int m_sessionHitches[HITCH_THRESHOLDS] = {0};
+        int m_frameIndex = 0;
+        int m_frameCount = 0;
+
+        float m_p50 = 0.0f, m_p95 = 0.0f, m_p99 = 0.0f, m_max = 0.0f;
+
+        static int binOf(float ms) {
+            return std::clamp(static_cast<int>(ms / HISTOGRAM_BIN_MS), 0, HISTOGRAM_BINS - 1);
+        }
+
+        float percentile(float p) {
+            if (m_frameCount == 0) {
+                return 0.0f;
+            }
+            int index = std::min(m_frameCount - 1, static_cast<int>(p * m_frameCount));
+            std::nth_element(m_sorted, m_sorted + index, m_sorted + m_frameCount);
+            return m_sorted[index];
+        }
+};
@@ -17,4 +17,6 @@ struct InputManager {
     bool mouseLeftWasPressed = false;
     bool mouseRightWasPressed = false;
     bool f2WasPressed = false;  
+    bool f3WasPressed = false;
+    bool f4WasPressed = false;
 };
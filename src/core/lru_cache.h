@@ -0,0 +1,67 @@
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+
+// Bounded, thread safe least-recently-used cache
+// get() refreshes an entry, put() evicts the oldest entry once capacity is reached
+// Values are copied out, so store cheap handles (shared_ptr) for anything big
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+    public:
+        explicit LruCache(size_t capacity) : m_capacity(capacity) {}
+
+        bool get(const Key& key, Value& value) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            auto it = m_index.find(key);
+            if (it == m_index.end()) {
+                return false;
+            }
+
+            // move the entry to the front of the recency list (O(1), iterators stay valid)
+            m_items.splice(m_items.begin(), m_items, it->second);
+            value = it->second->second;
+            return true;
+        }
+
+        void put(const Key& key, Value value) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            auto it = m_index.find(key);
+            if (it != m_index.end()) {
+                // another thread already inserted it, just refresh
+                it->second->second = std::move(value);
+                m_items.splice(m_items.begin(), m_items, it->second);
+                return;
+            }
+
+            m_items.emplace_front(key, std::move(value));
+            m_index[key] = m_items.begin();
+
+            if (m_items.size() > m_capacity) {
+                m_index.erase(m_items.back().first);
+                m_items.pop_back(); // evict least recently used
+            }
+        }
+
+        size_t size() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_items.size();
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_items.clear();
+            m_index.clear();
+        }
+
+    private:
+        size_t m_capacity;
+        std::list<std::pair<Key, Value>> m_items; // front = most recently used
+        std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator, Hash> m_index;
+        std::mutex m_mutex;
+};
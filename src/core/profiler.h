@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+// PROFILER
+// scoped zones recorded into per thread ring buffers, written out as a Chrome trace (chrome://tracing, ui.perfetto.dev)
+//
+//   PROFILE_ZONE("calculateChunkMesh");   // times the rest of the enclosing scope
+//
+// recording never locks: each thread only writes its own buffer and publishes it with a release store of the count.
+// A thread takes the registry mutex once, on its first zone. Zone names must be string literals (only the pointer is kept).
+// Compiled out unless ENABLE_PROFILING is defined (the CMake option of the same name, on by default)
+class Profiler {
+    public:
+        static constexpr size_t EVENTS_PER_THREAD = 1 << 15; // ring, oldest events are overwritten
+
+        struct Event {
+            const char* name;
+            int64_t startNs;
+            int64_t durationNs;
+        };
+
+        static int64_t now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start()).count();
+        }
+
+        static void record(const char* name, int64_t startNs, int64_t endNs) {
+            ThreadBuffer& buffer = threadBuffer();
+            size_t count = buffer.count.load(std::memory_order_relaxed);
+            buffer.events[count % EVENTS_PER_THREAD] = Event{name, startNs, endNs - startNs};
+            buffer.count.store(count + 1, std::memory_order_release);
+        }
+
+        // shown as the track name in the trace, call from the thread itself
+        static void setThreadName(const std::string& name) {
+            ThreadBuffer& buffer = threadBuffer();
+            std::lock_guard<std::mutex> lock(registryMutex());
+            buffer.name = name;
+        }
+
+        // safe while other threads keep recording, events overwritten during the copy are dropped
+        static bool writeChromeTrace(const std::string& path) {
+            std::ofstream file(path);
+            if (!file) {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(registryMutex());
+            file << "{\"traceEvents\":[\n";
+            bool first = true;
+            std::vector<Event> events;
+            for (const auto& buffer : registry()) {
+                file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+                     << ",\"args\":{\"name\":\"" << buffer->name << "\"}}";
+                first = false;
+
+                size_t end = buffer->count.load(std::memory_order_acquire);
+                size_t begin = end > EVENTS_PER_THREAD ? end - EVENTS_PER_THREAD : 0;
+                events.clear();
+                for (size_t i = begin; i < end; i++) {
+                    events.push_back(buffer->events[i % EVENTS_PER_THREAD]);
+                }
+                // whatever the owner wrote meanwhile overwrote the oldest slots we copied
+                size_t written = buffer->count.load(std::memory_order_acquire) - end;
+                size_t skip = std::min(written, events.size());
+
+                for (size_t i = skip; i < events.size(); i++) {
+                    const Event& event = events[i];
+                    file << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+                         << ",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << event.durationNs / 1000.0 << "}";
+                }
+            }
+            file << "\n]}\n";
+            return static_cast<bool>(file);
+        }
+
+    private:
+        struct ThreadBuffer {
+            int id = 0;
+            std::string name;
+            std::atomic<size_t> count{0};
+            std::unique_ptr<Event[]> events{new Event[EVENTS_PER_THREAD]};
+        };
+
+        // buffers outlive their threads, so a trace still has the workers after the threadpool shut down
+        static std::vector<std::unique_ptr<ThreadBuffer>>& registry() {
+            static std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+            return buffers;
+        }
+        static std::mutex& registryMutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+        static std::chrono::steady_clock::time_point start() {
+            static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+            return startTime;
+        }
+
+        static ThreadBuffer& threadBuffer() {
+            thread_local ThreadBuffer* buffer = nullptr;
+            if (!buffer) {
+                std::lock_guard<std::mutex> lock(registryMutex());
+                auto& buffers = registry();
+                buffers.push_back(std::make_unique<ThreadBuffer>());
+                buffer = buffers.back().get();
+                buffer->id = static_cast<int>(buffers.size());
+                buffer->name = "Thread " + std::to_string(buffer->id);
+            }
+            return *buffer;
+        }
+};
+
+class ProfileZone {
+    public:
+        explicit ProfileZone(const char* name) : m_name(name), m_start(Profiler::now()) {}
+        ~ProfileZone() { Profiler::record(m_name, m_start, Profiler::now()); }
+
+    private:
+        const char* m_name;
+        int64_t m_start;
+};
+
+#ifdef ENABLE_PROFILING
+    #define PROFILE_CONCAT_INNER(a, b) a##b
+    #define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+    #define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+    #define PROFILE_ZONE(name)
+#endif
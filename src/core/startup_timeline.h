@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+// Startup milestones in milliseconds since begin(), each one recorded once
+// single threaded, only touched by the main thread
+class StartupTimeline {
+    public:
+        struct Event {
+            std::string name;
+            float ms;
+        };
+
+        void begin() {
+            m_start = std::chrono::high_resolution_clock::now();
+            m_events.clear();
+        }
+
+        // records a milestone the first time its reached, later calls are ignored
+        void mark(const std::string& name) {
+            if (has(name)) {
+                return;
+            }
+            m_events.push_back(Event{name, elapsedMs()});
+        }
+
+        bool has(const std::string& name) const {
+            for (const Event& event : m_events) {
+                if (event.name == name) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        float elapsedMs() const {
+            return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - m_start).count();
+        }
+
+        const std::vector<Event>& events() const { return m_events; }
+
+        // one "<ms> <name>" line per milestone, in the order they happened
+        bool dump(const std::string& path) const {
+            std::ofstream file(path);
+            if (!file) {
+                return false;
+            }
+            for (const Event& event : m_events) {
+                file << event.ms << " " << event.name << "\n";
+            }
+            return static_cast<bool>(file);
+        }
+
+    private:
+        std::chrono::high_resolution_clock::time_point m_start;
+        std::vector<Event> m_events;
+};
@@ -1,5 +1,47 @@
 #pragma once
 
+#include <glm/glm.hpp>
+#include <core/constants.h>
+#include <functional>
+#include <sys/types.h>
+
+
+// floor division, plain '/' rounds towards zero which breaks negative coordinates
+inline int floorDiv(int a, int b) {
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+// Chunk coordinates of a block, shifts and masks instead of float floor or floorDiv.
+// >> on a negative int is an arithmetic shift on every compiler we build with (and guaranteed from C++20),
+// so -1 lands in chunk -1 at local 31 without a branch
+constexpr int chunkIndexOf(int block) { return block >> CHUNK_SHIFT; }      // chunk number, chunk origin / CHUNK_SIZE
+constexpr int chunkOriginOf(int block) { return block & ~CHUNK_MASK; }      // first block of the chunk
+constexpr int localOf(int block) { return block & CHUNK_MASK; }             // 0..CHUNK_SIZE-1 inside the chunk
+
+inline glm::ivec3 chunkIndexOf(glm::ivec3 block) { return glm::ivec3(chunkIndexOf(block.x), chunkIndexOf(block.y), chunkIndexOf(block.z)); }
+inline glm::ivec3 chunkOriginOf(glm::ivec3 block) { return glm::ivec3(chunkOriginOf(block.x), chunkOriginOf(block.y), chunkOriginOf(block.z)); }
+inline glm::ivec3 localOf(glm::ivec3 block) { return glm::ivec3(localOf(block.x), localOf(block.y), localOf(block.z)); }
+
+static_assert(chunkIndexOf(-1) == -1 && chunkOriginOf(-1) == -CHUNK_SIZE && localOf(-1) == CHUNK_SIZE - 1, "arithmetic shift required");
+static_assert(chunkIndexOf(CHUNK_SIZE) == 1 && chunkOriginOf(CHUNK_SIZE + 3) == CHUNK_SIZE && localOf(CHUNK_SIZE + 3) == 3);
+
+// Hash for chunk origin keys (multiples of CHUNK_SIZE). The low bits of the origins are always zero, so they are divided out
+// and the chunk numbers (21 bits each) go through the splitmix64 finalizer, every input bit then reaches every output bit.
+// Open addressing only uses the low bits of the hash, which the std::hash below leaves clustered for a grid of multiples of 32
+struct ChunkCoordHash {
+    size_t operator()(const glm::ivec3& chunkOrigin) const noexcept {
+        u_int64_t x = static_cast<u_int32_t>(chunkIndexOf(chunkOrigin.x)) & 0x1fffff;
+        u_int64_t y = static_cast<u_int32_t>(chunkIndexOf(chunkOrigin.y)) & 0x1fffff;
+        u_int64_t z = static_cast<u_int32_t>(chunkIndexOf(chunkOrigin.z)) & 0x1fffff;
+        u_int64_t h = (x << 42) | (y << 21) | z;
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return static_cast<size_t>(h);
+    }
+};
 
 // Hash function for glm::ivec3
 namespace std {
@@ -13,4 +55,14 @@ namespace std {
             return hx ^ hy ^ hz;
         }
     };
-}
\ No newline at end of file
+
+    // Hash function for glm::ivec2 (chunk column x/z)
+    template<>
+    struct hash<glm::ivec2> {
+        std::size_t operator()(const glm::ivec2& v) const noexcept {
+            std::size_t hx = std::hash<int>()(v.x) * 73856093;
+            std::size_t hy = std::hash<int>()(v.y) * 83492791;
+            return hx ^ hy;
+        }
+    };
+}
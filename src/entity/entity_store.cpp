@@ -0,0 +1,183 @@
+#include <entity/entity_store.h>
+#include <world/world.h>
+#include <physics/collision.h>
+#include <threadpool/threadpool.h>
+#include <core/profiler.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+
+size_t EntityStore::spawn(glm::vec3 position, glm::vec3 velocity, glm::vec3 size) {
+    positions.push_back(position);
+    velocities.push_back(velocity);
+    sizes.push_back(size);
+    onGround.push_back(0);
+    return positions.size() - 1;
+}
+
+void EntityStore::remove(size_t index) {
+    positions[index] = positions.back();
+    velocities[index] = velocities.back();
+    sizes[index] = sizes.back();
+    onGround[index] = onGround.back();
+    positions.pop_back();
+    velocities.pop_back();
+    sizes.pop_back();
+    onGround.pop_back();
+}
+
+void EntityStore::clear() {
+    positions.clear();
+    velocities.clear();
+    sizes.clear();
+    onGround.clear();
+}
+
+void EntityStore::update(World& world, Threadpool* threadpool, float deltaTime) {
+    PROFILE_ZONE("EntityStore::update");
+    size_t count = positions.size();
+    m_pairTests = 0;
+    m_contacts = 0;
+    if (count == 0) {
+        return;
+    }
+
+    auto parallel = [&](auto fn) {
+        if (threadpool) {
+            threadpool->parallelFor(count, ENTITIES_PER_RANGE, fn);
+        } else {
+            fn(0, count);
+        }
+    };
+
+    // Broadphase, reads positions and only writes each entitys own push, so ranges dont need any locking
+    auto startBroadphase = std::chrono::high_resolution_clock::now();
+    buildSpatialHash();
+    m_pushes.assign(count, glm::vec3(0));
+    std::atomic<size_t> pairTests{0}, contacts{0};
+    parallel([&](size_t begin, size_t end) {
+        size_t rangePairTests = 0, rangeContacts = 0;
+        findContacts(begin, end, rangePairTests, rangeContacts);
+        pairTests += rangePairTests;
+        contacts += rangeContacts;
+    });
+    m_pairTests = pairTests;
+    m_contacts = contacts / 2; // both entities of a pair count it
+    auto startIntegrate = std::chrono::high_resolution_clock::now();
+    m_broadphaseMs = std::chrono::duration<double, std::milli>(startIntegrate - startBroadphase).count();
+
+    // Movement and voxel collision
+    parallel([&](size_t begin, size_t end) {
+        integrate(world, begin, end, deltaTime);
+    });
+    m_integrateMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startIntegrate).count();
+}
+
+glm::ivec3 EntityStore::cellOf(glm::vec3 position) const {
+    return glm::ivec3(glm::floor(position / m_cellSize));
+}
+
+u_int32_t EntityStore::bucketOf(glm::ivec3 cell) const {
+    u_int32_t hash = static_cast<u_int32_t>(cell.x) * 73856093u ^ static_cast<u_int32_t>(cell.y) * 19349663u ^ static_cast<u_int32_t>(cell.z) * 83492791u;
+    return hash & static_cast<u_int32_t>(m_bucketStart.size() - 2); // bucket count is a power of two, plus the end sentinel
+}
+
+void EntityStore::buildSpatialHash() {
+    size_t count = positions.size();
+
+    // cells at least as big as the largest entity on each axis, so overlapping entities are always in neighbouring cells
+    glm::vec3 largest(0.0f);
+    for (const glm::vec3& size : sizes) {
+        largest = glm::max(largest, size);
+    }
+    m_cellSize = glm::max(largest, glm::vec3(0.25f));
+
+    size_t buckets = 1;
+    while (buckets < count * 2) {
+        buckets <<= 1;
+    }
+    m_bucketStart.assign(buckets + 1, 0);
+    m_cellHashes.resize(count);
+    m_sorted.resize(count);
+    m_sortedCells.resize(count);
+
+    // counting sort by bucket
+    for (size_t i = 0; i < count; i++) {
+        m_cellHashes[i] = bucketOf(cellOf(positions[i]));
+        m_bucketStart[m_cellHashes[i] + 1]++;
+    }
+    for (size_t b = 0; b < buckets; b++) {
+        m_bucketStart[b + 1] += m_bucketStart[b];
+    }
+    std::vector<u_int32_t> fill(m_bucketStart.begin(), m_bucketStart.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+        u_int32_t slot = fill[m_cellHashes[i]]++;
+        m_sorted[slot] = static_cast<u_int32_t>(i);
+        m_sortedCells[slot] = cellOf(positions[i]);
+    }
+}
+
+void EntityStore::findContacts(size_t begin, size_t end, size_t& pairTests, size_t& contacts) {
+    for (size_t i = begin; i < end; i++) {
+        glm::vec3 halfI = sizes[i] * 0.5f;
+        glm::vec3 centreI = positions[i] + glm::vec3(0.0f, halfI.y, 0.0f);
+        glm::ivec3 cell = cellOf(positions[i]);
+
+        for (int dx = -1; dx <= 1; dx++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dz = -1; dz <= 1; dz++) {
+                    glm::ivec3 neighbourCell = cell + glm::ivec3(dx, dy, dz);
+                    u_int32_t bucket = bucketOf(neighbourCell);
+                    for (u_int32_t k = m_bucketStart[bucket]; k < m_bucketStart[bucket + 1]; k++) {
+                        u_int32_t j = m_sorted[k];
+                        // skipping other cells in the bucket also means a pair is never seen twice through two colliding cells
+                        if (j == i || m_sortedCells[k] != neighbourCell) {
+                            continue;
+                        }
+                        pairTests++;
+                        glm::vec3 halfJ = sizes[j] * 0.5f;
+                        glm::vec3 centreJ = positions[j] + glm::vec3(0.0f, halfJ.y, 0.0f);
+                        glm::vec3 overlap = halfI + halfJ - glm::abs(centreI - centreJ);
+                        if (overlap.x <= 0.0f || overlap.y <= 0.0f || overlap.z <= 0.0f) {
+                            continue;
+                        }
+                        contacts++;
+
+                        // push apart horizontally along the axis of least overlap, stacking is left to the voxel collision
+                        glm::vec3 away = centreI - centreJ;
+                        if (overlap.x < overlap.z) {
+                            float direction = (away.x != 0.0f) ? std::copysign(1.0f, away.x) : (i < j ? -1.0f : 1.0f);
+                            m_pushes[i].x += direction * overlap.x * pushStrength;
+                        } else {
+                            float direction = (away.z != 0.0f) ? std::copysign(1.0f, away.z) : (i < j ? -1.0f : 1.0f);
+                            m_pushes[i].z += direction * overlap.z * pushStrength;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void EntityStore::integrate(World& world, size_t begin, size_t end, float deltaTime) {
+    Collision collision; // its gather buffer is per thread
+    std::shared_lock<std::shared_mutex> lock(world.chunkMapMutex);
+    for (size_t i = begin; i < end; i++) {
+        glm::vec3& velocity = velocities[i];
+        if (!onGround[i]) {
+            velocity.y = std::max(velocity.y - gravity * deltaTime, -terminalVelocity);
+        }
+
+        glm::bvec3 blocked;
+        bool grounded;
+        positions[i] = collision.moveBox(world, positions[i], sizes[i], velocity * deltaTime + m_pushes[i], blocked, grounded);
+        onGround[i] = grounded;
+
+        // walkers turn around at walls, anything vertical stops
+        if (blocked.x) velocity.x = -velocity.x;
+        if (blocked.z) velocity.z = -velocity.z;
+        if (blocked.y) velocity.y = 0.0f;
+    }
+}
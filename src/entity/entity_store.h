@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstddef>
+#include <sys/types.h>
+
+
+// Forward Declarations
+class World;
+class Threadpool;
+
+// ENTITY STORE
+// simple physics entities (falling, walking, pushing each other apart), kept as one array per attribute so a tick streams
+// through exactly the data it needs. Entities are indices, removing one moves the last entity into its slot.
+//
+// A tick: entity-entity contacts through a spatial hash, then gravity, movement and voxel collision (the player's swept AABB)
+// in ranges over the threadpool, each range holding the chunk map lock once
+//
+// not driven by Game yet, only entity_bench creates one. The renderer has nothing to draw entities with and nothing spawns them,
+// ticking an invisible store every frame would only cost time. Game should own one and call update with m_tickTime in the fixed tick
+class EntityStore {
+    public:
+        // Per entity data, index i of every array is entity i
+        std::vector<glm::vec3> positions;   // bottom centre
+        std::vector<glm::vec3> velocities;  // blocks/s
+        std::vector<glm::vec3> sizes;       // AABB width, height, depth
+        std::vector<u_int8_t> onGround;
+
+        float gravity = 30.0f;
+        float terminalVelocity = 50.0f;
+        float pushStrength = 0.5f; // share of an overlap each entity moves out per tick
+
+        size_t spawn(glm::vec3 position, glm::vec3 velocity, glm::vec3 size);
+        void remove(size_t index);
+        void clear();
+        size_t size() const { return positions.size(); }
+
+        // threadpool nullptr runs everything on the calling thread
+        void update(World& world, Threadpool* threadpool, float deltaTime);
+
+        // last update
+        size_t getPairTests() const { return m_pairTests; }
+        size_t getContacts() const { return m_contacts; }
+        double getBroadphaseMs() const { return m_broadphaseMs; }
+        double getIntegrateMs() const { return m_integrateMs; }
+
+    private:
+        static constexpr size_t ENTITIES_PER_RANGE = 512;
+
+        // spatial hash, entities counting sorted by the hash of their cell: bucket b holds m_sorted[m_bucketStart[b] .. m_bucketStart[b+1])
+        // m_sortedCells keeps the cell of each sorted entity, a bucket can hold other cells that hashed the same
+        glm::vec3 m_cellSize = glm::vec3(1.0f); // per axis, tall entities get tall cells
+        std::vector<u_int32_t> m_cellHashes;
+        std::vector<u_int32_t> m_bucketStart;
+        std::vector<u_int32_t> m_sorted;
+        std::vector<glm::ivec3> m_sortedCells;
+        std::vector<glm::vec3> m_pushes; // separation from the contacts, applied with the movement
+
+        size_t m_pairTests = 0;
+        size_t m_contacts = 0;
+        double m_broadphaseMs = 0.0;
+        double m_integrateMs = 0.0;
+
+        glm::ivec3 cellOf(glm::vec3 position) const;
+        u_int32_t bucketOf(glm::ivec3 cell) const;
+        void buildSpatialHash();
+        void findContacts(size_t begin, size_t end, size_t& pairTests, size_t& contacts);
+        void integrate(World& world, size_t begin, size_t end, float deltaTime);
+};
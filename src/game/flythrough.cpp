@@ -0,0 +1,87 @@
+#include <game/flythrough.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+
+bool Flythrough::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open flythrough " << path << std::endl;
+        return false;
+    }
+
+    samples.clear();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        FlythroughSample sample;
+        if (!(fields >> sample.time >> sample.position.x >> sample.position.y >> sample.position.z >> sample.yaw >> sample.pitch)) {
+            std::cerr << "Bad flythrough sample at " << path << ":" << lineNumber << std::endl;
+            return false;
+        }
+        if (!samples.empty() && sample.time < samples.back().time) {
+            std::cerr << "Flythrough samples go back in time at " << path << ":" << lineNumber << std::endl;
+            return false;
+        }
+        samples.push_back(sample);
+    }
+
+    if (samples.empty()) {
+        std::cerr << "Flythrough " << path << " has no samples" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Flythrough::save(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open flythrough " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    file << "# flythrough v1: time x y z yaw pitch\n";
+    for (const FlythroughSample& sample : samples) {
+        file << sample.time << " " << sample.position.x << " " << sample.position.y << " " << sample.position.z << " "
+             << sample.yaw << " " << sample.pitch << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+FlythroughSample Flythrough::sampleAt(float time) const {
+    if (samples.empty()) {
+        return FlythroughSample{0.0f, glm::vec3(0.0f), -90.0f, 0.0f};
+    }
+    if (time <= samples.front().time) {
+        return samples.front();
+    }
+    if (time >= samples.back().time) {
+        return samples.back();
+    }
+
+    // first sample after t, the one before it is at or before t
+    auto next = std::upper_bound(samples.begin(), samples.end(), time, [](float t, const FlythroughSample& sample) { return t < sample.time; });
+    const FlythroughSample& a = *(next - 1);
+    const FlythroughSample& b = *next;
+    float span = b.time - a.time;
+    float blend = span > 0.0f ? (time - a.time) / span : 1.0f;
+
+    // yaw takes the short way round, recordings can wrap past +-180
+    float yawDelta = std::fmod(b.yaw - a.yaw + 540.0f, 360.0f) - 180.0f;
+
+    FlythroughSample sample;
+    sample.time = time;
+    sample.position = glm::mix(a.position, b.position, blend);
+    sample.yaw = a.yaw + yawDelta * blend;
+    sample.pitch = a.pitch + (b.pitch - a.pitch) * blend;
+    return sample;
+}
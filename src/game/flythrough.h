@@ -0,0 +1,36 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+
+// FLYTHROUGH
+// a recorded camera path, replayed at a fixed timestep so runs on different builds or machines see the same frames
+//
+// file: text, '#' lines are comments, then one sample per line
+//   time x y z yaw pitch     (seconds from the start, player feet position, camera angles in degrees)
+struct FlythroughSample {
+    float time;
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+};
+
+class Flythrough {
+    public:
+        bool load(const std::string& path);
+        bool save(const std::string& path) const;
+
+        void clear() { samples.clear(); }
+        void addSample(const FlythroughSample& sample) { samples.push_back(sample); }
+
+        // pose at time t, linearly interpolated, clamped to the ends of the path
+        FlythroughSample sampleAt(float time) const;
+        float getDuration() const { return samples.empty() ? 0.0f : samples.back().time; }
+        bool empty() const { return samples.empty(); }
+        size_t size() const { return samples.size(); }
+
+    private:
+        std::vector<FlythroughSample> samples; // sorted by time
+};
@@ -1,4 +1,5 @@
 #include <game/game.h>
+#include <fstream>
 
 void Game::processInput() {
     // Close window
@@ -30,28 +31,28 @@ void Game::processInput() {
     }
     glm::vec3 right = glm::normalize(glm::cross(front, m_camera.up));
 
-    glm::vec3 xz_movement(0.0f);
+    glm::vec3 xz_direction(0.0f);
 
     // WSAD movement
     if (glfwGetKey(m_window, GLFW_KEY_W) == GLFW_PRESS){
-        xz_movement += front * speed * currentMoveScale;
+        xz_direction += front * currentMoveScale;
     }
     if (glfwGetKey(m_window, GLFW_KEY_S) == GLFW_PRESS){
-        xz_movement -= front * speed * currentMoveScale;
+        xz_direction -= front * currentMoveScale;
     }
     if (glfwGetKey(m_window, GLFW_KEY_D) == GLFW_PRESS){
-        xz_movement += right * speed * currentMoveScale;
+        xz_direction += right * currentMoveScale;
     }
     if (glfwGetKey(m_window, GLFW_KEY_A) == GLFW_PRESS){
-        xz_movement -= right * speed * currentMoveScale;
+        xz_direction -= right * currentMoveScale;
     }
     
     glm::vec3 oldPos = m_player.position;
     if (!m_player.creativeMode) {
-        m_player.position = m_collision.resolveXZCollision(m_player.position + xz_movement, xz_movement, m_world, m_player);
+        m_walkVelocity = xz_direction * m_camera.speed; // applied by the physics ticks in update(), together with gravity
     } 
     else {
-        m_player.position += xz_movement;
+        m_player.position += xz_direction * speed;
         if (glfwGetKey(m_window, GLFW_KEY_SPACE) == GLFW_PRESS){
             m_player.position.y += speed;
         }
@@ -72,6 +73,9 @@ void Game::processInput() {
     }
     m_input.spaceWasPressed = spaceIsPressed;
 
+    // edit latency is measured from here, the upload that makes it visible is timed against this
+    auto editTime = std::chrono::steady_clock::now();
+
     // Block Removal
     bool mouseLeftIsPressed = glfwGetMouseButton(m_window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
     if (mouseLeftIsPressed && !m_input.mouseLeftWasPressed && m_selectedBlock != glm::ivec3(INT_MAX)) {
@@ -84,7 +88,7 @@ void Game::processInput() {
             // Prevent removing bedrock in survival mode
             if (m_player.creativeMode || m_selectedBlock.y != -m_world.Y_LIMIT) {
                 m_world.setBlock(m_selectedBlock, 0); // Set to air
-                m_world.updateChunkAndNeighboursMesh(m_selectedBlock); // Recalculate meshes
+                m_world.updateChunkAndNeighboursMesh(m_selectedBlock, editTime); // Recalculate meshes
             }
         }
     }
@@ -100,7 +104,7 @@ void Game::processInput() {
         }
         if(block && block->type == 0) { // Check if block is air
             m_world.setBlock(m_previousBlock, m_curBlockType); 
-            m_world.updateChunkAndNeighboursMesh(m_previousBlock);
+            m_world.updateChunkAndNeighboursMesh(m_previousBlock, editTime);
         }
     }
     m_input.mouseRightWasPressed = mouseRightIsPressed;
@@ -117,6 +121,33 @@ void Game::processInput() {
     }
     m_input.f2WasPressed = rIsPressed;
 
+    // Dump a trace of the profiling zones (open in chrome://tracing or ui.perfetto.dev)
+    bool f3IsPressed = glfwGetKey(m_window, GLFW_KEY_F3) == GLFW_PRESS;
+    if (f3IsPressed && !m_input.f3WasPressed) {
+        if (Profiler::writeChromeTrace(m_tracePath)) {
+            std::cout << "Wrote profiling trace to " << m_tracePath << std::endl;
+        } else {
+            std::cerr << "Failed to write profiling trace to " << m_tracePath << std::endl;
+        }
+    }
+    m_input.f3WasPressed = f3IsPressed;
+
+    // Start / stop recording a flythrough
+    bool f4IsPressed = glfwGetKey(m_window, GLFW_KEY_F4) == GLFW_PRESS;
+    if (f4IsPressed && !m_input.f4WasPressed) {
+        if (m_recording) {
+            if (m_flythrough.save(m_recordPath)) {
+                std::cout << "Saved " << m_flythrough.size() << " flythrough samples to " << m_recordPath << std::endl;
+            }
+        } else {
+            m_flythrough.clear();
+            m_recordStart = m_lastFrame;
+            std::cout << "Recording flythrough, F4 to stop" << std::endl;
+        }
+        m_recording = !m_recording;
+    }
+    m_input.f4WasPressed = f4IsPressed;
+
     if (glfwGetKey(m_window, GLFW_KEY_1) == GLFW_PRESS) {
         m_curBlockType = 1;
     }
@@ -125,93 +156,99 @@ void Game::processInput() {
     }
     if (glfwGetKey(m_window, GLFW_KEY_3) == GLFW_PRESS) {
         m_curBlockType = 3;
+    }
+    if (glfwGetKey(m_window, GLFW_KEY_4) == GLFW_PRESS) {
+        m_curBlockType = 4;
+    }
+    if (glfwGetKey(m_window, GLFW_KEY_5) == GLFW_PRESS) {
+        m_curBlockType = 5;
     }    
 }
 
 void Game::update() {
+    PROFILE_ZONE("Update");
 
-    // physics and chunk updation only for non-creative mode
+    // physics only for non-creative mode, in fixed ticks so it behaves the same at any frame rate
     if (!m_player.creativeMode) {
-        m_physics.updatePhysics(m_player, m_collision, m_world, m_deltaTime, m_playerMovedChunks);
+        auto startPhysics = std::chrono::high_resolution_clock::now();
+        m_tickAccumulator += m_tickDeltaTime;
+        int ticks = 0;
+        while (m_tickAccumulator >= m_tickTime && ticks < m_maxTicksPerFrame) {
+            PROFILE_ZONE("Physics tick");
+            m_previousTickPosition = m_player.position;
+            m_physics.updatePhysics(m_player, m_collision, m_world, m_tickTime, m_walkVelocity * m_tickTime, m_playerMovedChunks);
+            m_tickAccumulator -= m_tickTime;
+            ticks++;
+        }
+        // after a long hitch drop the backlog instead of spending the next frames catching up
+        if (ticks == m_maxTicksPerFrame && m_tickAccumulator > m_tickTime) {
+            m_droppedTickTime += m_tickAccumulator - m_tickTime;
+            m_tickAccumulator = m_tickTime;
+        }
+        m_lastTickCount = ticks;
+        m_frameStats.addTime(SUBSYSTEM::PHYSICS, std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startPhysics).count());
+
+        // the view sits between the last two ticks, by how far the accumulator is into the next one
+        m_renderPosition = glm::mix(m_previousTickPosition, m_player.position, m_tickAccumulator / m_tickTime);
+    } else {
+        // creative moves the player directly every frame, nothing to interpolate
+        m_tickAccumulator = 0.0f;
+        m_lastTickCount = 0;
+        m_previousTickPosition = m_player.position;
+        m_renderPosition = m_player.position;
+    }
+    // smoothed over a few frames, a single frame of collision or a teleport shouldnt swing the prefetch around
+    if (m_deltaTime > 0.0f) {
+        glm::vec3 frameVelocity = (m_player.position - m_lastPlayerPosition) / m_deltaTime;
+        m_playerVelocity = glm::mix(m_playerVelocity, frameVelocity, 0.2f);
     }
+    m_lastPlayerPosition = m_player.position;
+
     if (m_playerMovedChunks) {
-        glm::vec3 playerPosition = m_player.position;
-        m_threadpool.enqueueBackWorkerTask([this, playerPosition]{
-            m_world.generateChunks(playerPosition);
-        });
+        m_world.requestChunks(m_player.position, m_playerVelocity, m_camera.front);
         m_playerMovedChunks = false;
     }
     // Update camera position to follow player's eyes
-    m_camera.position = m_player.position + glm::vec3(0.0f, m_player.eyeHeight, 0.0f);
+    m_camera.position = m_renderPosition + glm::vec3(0.0f, m_player.eyeHeight, 0.0f);
+    auto startRaycast = std::chrono::high_resolution_clock::now();
     performRaycasting();
+    m_frameStats.addTime(SUBSYSTEM::RAYCAST, std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startRaycast).count());
 
-    m_threadpool.processMainThreadTasks(); // empty the main thread task queue and execute tasks (uploading chunk meshes)
+    // persist edited chunks every few seconds, the writing happens on a worker
+    if (m_lastFrame - m_lastSaveTime > m_saveInterval) {
+        m_world.saveDirtyChunks();
+        m_lastSaveTime = m_lastFrame;
+    }
+
+    // execute main thread tasks (uploading chunk meshes) in whatever is left of the frame
+    m_lastUploads = m_threadpool.processMainThreadTasks(m_framePacing.getUploadBudgetMs(), m_framePacing.getUploadBudgetBytes());
+    m_frameStats.addTime(SUBSYSTEM::UPLOADS, static_cast<float>(m_lastUploads.ms));
 }
 
 void Game::render() {
+    PROFILE_ZONE("Render");
     m_renderer.render(m_selectedBlock, m_camera, m_player, m_world, m_window);
-    m_renderer.renderImGui(m_player, m_world, m_updateTimes, m_renderTimes, m_queueSizes, m_timeIndex);
+    m_frameStats.addTime(SUBSYSTEM::CULLING, m_renderer.cullingTime);
+    m_frameStats.addTime(SUBSYSTEM::DRAW, m_renderer.drawTime);
+    m_renderer.renderImGui(m_player, m_world, m_updateTimes, m_renderTimes, m_queueSizes, m_holeCounts, m_timeIndex, m_lastTickCount, m_droppedTickTime, m_startupTimeline, m_framePacing, m_frameStats);
 }
 
 void Game::performRaycasting() {
-    glm::vec3 rayDirection = glm::normalize(m_camera.front);
-    glm::vec3 rayOrigin = m_camera.position;
- 
-    float closestHit = m_rayEnd;
-    glm::ivec3 bestHit = glm::ivec3(INT_MAX);
-    glm::ivec3 bestPrev = glm::ivec3(INT_MAX);
-
-    for (const auto& offset : m_rayStarts) {
-        glm::vec3 curRayOrigin = rayOrigin + offset; // Adjust ray start based on offset
-        glm::ivec3 prevBlockThisRay = glm::ivec3(INT_MAX); // Reset previous block to an unlikely value
-
-        for (float i = m_rayStart; i < closestHit; i += m_rayStep) {
-            glm::vec3 point = curRayOrigin + rayDirection * i; 
-            glm::ivec3 blockPosition = glm::ivec3(glm::round(point));
-            
-            if(blockPosition == prevBlockThisRay) continue;
-
-            Block* hitBlock;
-            { 
-                std::shared_lock<std::shared_mutex> lock(m_world.chunkMapMutex);
-                hitBlock = m_world.getBlock(blockPosition);
-            }
-            if (hitBlock && hitBlock->type != 0) {
-                // We hit a non-air block
-                if (i < closestHit){
-                    closestHit = i; 
-                    bestHit = blockPosition;
-
-                    // Check if the previous block is valid for placement
-                    BoundingBox prevBlockBox = BoundingBox::box(prevBlockThisRay, BLOCK_SIZE, BLOCK_SIZE, BLOCK_SIZE);                      
-
-                    // here pass the position as playerposition.y - height/2 cause the y of the player is at the bottom of the player not the center
-                    BoundingBox playerBox = BoundingBox::box(m_player.position - glm::vec3(0.0f, -m_player.height/2, 0.0f), m_player.width, m_player.height, m_player.depth);
-
-                    // cannot be previous block(block to be placed) if block overlaps with players bounding box
-                    if (!m_collision.boxBoxOverlap(playerBox, prevBlockBox)) {
-                        bestPrev = prevBlockThisRay;
-                    } else {
-                        bestPrev = glm::ivec3(INT_MAX); // Invalid if player would be inside it
-                    }
-                    break; // Found the closest hit for this thickened ray, move to the next
-                }
-            }
-            prevBlockThisRay = blockPosition;            
-        }
-    }
-    
-    // Set the final results as member variables
-    this->m_selectedBlock = bestHit;
-    this->m_previousBlock = bestPrev;
+    float reach = m_player.creativeMode ? m_creativeRayEnd : m_rayEnd;
+    RaycastHit hit = raycastBlocks(m_world, m_camera.position, m_camera.front, reach);
 
-    if (m_selectedBlock == glm::ivec3(INT_MAX) || m_previousBlock == glm::ivec3(INT_MAX)) return;
+    this->m_selectedBlock = hit.block;
+    this->m_previousBlock = hit.previous;
+    if (m_previousBlock == glm::ivec3(INT_MAX)) return;
 
-    // The closest Block could still not be face alligned, So check its manhatten distance to the previous block
-    glm::ivec3 delta = m_selectedBlock - m_previousBlock;
-    if (abs(delta.x) + abs(delta.y) + abs(delta.z) != 1) {
+    // here pass the position as playerposition.y - height/2 cause the y of the player is at the bottom of the player not the center
+    BoundingBox prevBlockBox = BoundingBox::box(m_previousBlock, BLOCK_SIZE, BLOCK_SIZE, BLOCK_SIZE);
+    BoundingBox playerBox = BoundingBox::box(m_player.position - glm::vec3(0.0f, -m_player.height/2, 0.0f), m_player.width, m_player.height, m_player.depth);
+
+    // cannot be previous block(block to be placed) if block overlaps with players bounding box
+    if (m_collision.boxBoxOverlap(playerBox, prevBlockBox)) {
         this->m_previousBlock = glm::ivec3(INT_MAX);
-    }        
+    }
 }
 
 void Game::initGlfw() {
@@ -223,6 +260,9 @@ void Game::initGlfw() {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (m_hiddenWindow) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); // benchmark machines may have no display to show it on (software GL)
+    }
     #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     #endif
@@ -234,6 +274,15 @@ void Game::initGlfw() {
         exit(-1);
     }
     glfwMakeContextCurrent(m_window);
+    if (m_replaying) {
+        glfwSwapInterval(0); // replays measure the frame work, not the refresh rate
+    }
+
+    // pace main thread work against the monitor refresh rate
+    const GLFWvidmode* videoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    if (videoMode && videoMode->refreshRate > 0) {
+        m_framePacing.setTargetFrameMs(1000.0f / videoMode->refreshRate);
+    }
 
     // This is the crucial link between the GLFW window and our Game instance
     glfwSetWindowUserPointer(m_window, this);
@@ -256,6 +305,12 @@ void Game::initGlad() {
 
 void Game::initWorld() {
     m_world.init(m_player.position, &m_threadpool);  
+    if (m_replaying) {
+        m_player.position = m_flythrough.sampleAt(0.0f).position; // init drops the player onto the terrain, the path knows better
+    }
+    m_lastPlayerPosition = m_player.position;
+    m_previousTickPosition = m_player.position;
+    m_renderPosition = m_player.position;
 }
 
 void Game::initRenderer() {
@@ -293,11 +348,7 @@ void Game::onMouseMovement(double xpos, double ypos) {
     if (m_camera.pitch < -m_camera.maxPitch) m_camera.pitch = -m_camera.maxPitch;
 
     // Recalculate the camera's front vector
-    glm::vec3 direction;
-    direction.x = cos(glm::radians(m_camera.yaw)) * cos(glm::radians(m_camera.pitch));
-    direction.y = sin(glm::radians(m_camera.pitch));
-    direction.z = sin(glm::radians(m_camera.yaw)) * cos(glm::radians(m_camera.pitch));
-    m_camera.front = glm::normalize(direction);
+    m_camera.updateFront();
 }
 
 void Game::mouse_callback_router(GLFWwindow* window, double xpos, double ypos) {
@@ -312,12 +363,211 @@ void Game::framebuffer_size_callback(GLFWwindow* window, int width, int height)
     glViewport(0, 0, width, height);
 }
 
+void Game::updateStartupTimeline() {
+    if (m_startupReported) {
+        return;
+    }
+
+    int ready = m_world.startupReadyChunks;
+    if (ready > 0) {
+        m_startupTimeline.mark("First chunk uploaded");
+    }
+    if (ready * 2 >= m_world.startupChunkTarget) {
+        m_startupTimeline.mark("50% of view uploaded");
+    }
+    if (ready * 10 >= m_world.startupChunkTarget * 9) {
+        m_startupTimeline.mark("90% of view uploaded");
+    }
+    if (ready >= m_world.startupChunkTarget) {
+        m_startupTimeline.mark("100% of view uploaded");
+    }
+    if (m_threadpool.isIdle()) {
+        m_startupTimeline.mark("Workers idle"); // the load ring around the view is done too
+    }
+
+    if (!m_startupTimeline.has("100% of view uploaded") || !m_startupTimeline.has("Workers idle")) {
+        return;
+    }
+    m_startupReported = true;
+
+    std::cout << "World ready in " << m_startupTimeline.elapsedMs() / 1000.0f << " s: " << m_world.generatedChunkCount << " chunks generated, "
+              << m_world.cachedChunkCount << " from the chunk cache, " << m_world.storedChunkCount << " from region files" << std::endl;
+    for (const auto& event : m_startupTimeline.events()) {
+        std::cout << "  " << event.ms << " ms  " << event.name << std::endl;
+    }
+    if (!m_startupTimeline.dump("startup_timeline.txt")) {
+        std::cerr << "Failed to write startup_timeline.txt" << std::endl;
+    }
+}
+
+void Game::setReplay(const std::string& path, const std::string& reportPath, bool hiddenWindow) {
+    m_replayPath = path;
+    m_reportPath = reportPath;
+    m_hiddenWindow = hiddenWindow;
+    m_replaying = true;
+}
+
+void Game::updateRecording() {
+    if (!m_recording) {
+        return;
+    }
+    m_flythrough.addSample(FlythroughSample{m_lastFrame - m_recordStart, m_player.position, m_camera.yaw, m_camera.pitch});
+}
+
+void Game::updateReplay() {
+    // the path starts once the world around its first sample is there, startup is measured on its own
+    if (!m_replayStarted) {
+        if (!m_startupReported) {
+            return;
+        }
+        m_replayStarted = true;
+        m_replayTime = 0.0f;
+        m_replayTotals.startupMs = m_startupTimeline.elapsedMs();
+        m_replayTotals.generatedStart = m_world.generatedChunkCount;
+        m_replayTotals.cachedStart = m_world.cachedChunkCount;
+        m_replayTotals.storedStart = m_world.storedChunkCount;
+        m_replayTotals.meshedStart = m_world.meshedChunkCount;
+    } else {
+        m_replayTime += m_replayTimestep;
+    }
+
+    if (m_replayTime > m_flythrough.getDuration()) {
+        if (!writeReplayReport()) {
+            std::cerr << "Failed to write replay report " << m_reportPath << std::endl;
+        }
+        glfwSetWindowShouldClose(m_window, true);
+        return;
+    }
+
+    FlythroughSample sample = m_flythrough.sampleAt(m_replayTime);
+    glm::vec3 oldPos = m_player.position;
+    m_player.position = sample.position;
+    m_camera.yaw = sample.yaw;
+    m_camera.pitch = sample.pitch;
+    m_camera.updateFront();
+    if (m_world.getChunkOrigin(m_player.position) != m_world.getChunkOrigin(oldPos)) {
+        m_playerMovedChunks = true;
+    }
+}
+
+void Game::recordReplayFrame(float frameTime) {
+    if (!m_replayStarted) {
+        return;
+    }
+    ReplayTotals& totals = m_replayTotals;
+    totals.frameTimes.push_back(frameTime);
+    for (int i = 0; i < static_cast<int>(SUBSYSTEM::COUNT); i++) {
+        totals.subsystemTimes[i] += m_frameStats.getLastSubsystemTime(static_cast<SUBSYSTEM>(i));
+    }
+    totals.uploadMs += m_lastUploads.ms;
+    totals.uploadBytes += m_lastUploads.bytes;
+    totals.uploadTasks += m_lastUploads.tasks;
+    totals.holes += m_renderer.frustumHoles;
+    totals.maxHoles = std::max(totals.maxHoles, m_renderer.frustumHoles);
+    totals.maxWorkerQueue = std::max(totals.maxWorkerQueue, m_threadpool.getWorkerQueueSize());
+}
+
+// the replay path comes from the command line, it can hold quotes, backslashes (windows) or worse
+static std::string escapeJson(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+            case '"':  escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char code[8];
+                    snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(c));
+                    escaped += code;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+bool Game::writeReplayReport() {
+    ReplayTotals& totals = m_replayTotals;
+    std::vector<float> sorted = totals.frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](float p) {
+        return sorted.empty() ? 0.0f : sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+    };
+    size_t frames = std::max<size_t>(1, sorted.size());
+    double totalMs = 0.0;
+    for (float ms : sorted) {
+        totalMs += ms;
+    }
+
+    std::ofstream report(m_reportPath);
+    if (!report) {
+        return false;
+    }
+    report << "{\n";
+    report << "  \"path\": \"" << escapeJson(m_replayPath) << "\",\n";
+    report << "  \"duration_s\": " << m_flythrough.getDuration() << ",\n";
+    report << "  \"timestep_ms\": " << m_replayTimestep * 1000.0f << ",\n";
+    report << "  \"frames\": " << sorted.size() << ",\n";
+    report << "  \"startup_ms\": " << totals.startupMs << ",\n";
+    report << "  \"frame_ms\": { \"mean\": " << totalMs / frames << ", \"p50\": " << percentile(0.50f) << ", \"p95\": " << percentile(0.95f)
+           << ", \"p99\": " << percentile(0.99f) << ", \"max\": " << (sorted.empty() ? 0.0f : sorted.back()) << " },\n";
+
+    report << "  \"hitches\": {";
+    for (int i = 0; i < FrameStats::HITCH_THRESHOLDS; i++) {
+        float threshold = m_frameStats.hitchThresholdsMs[i];
+        long count = std::count_if(sorted.begin(), sorted.end(), [&](float ms) { return ms > threshold; });
+        report << (i ? ", " : " ") << "\"" << threshold << "\": " << count;
+    }
+    report << " },\n";
+
+    report << "  \"subsystem_mean_ms\": {";
+    for (int i = 0; i < static_cast<int>(SUBSYSTEM::COUNT); i++) {
+        report << (i ? ", " : " ") << "\"" << subsystemNames[i] << "\": " << totals.subsystemTimes[i] / frames;
+    }
+    report << " },\n";
+
+    report << "  \"generation\": { \"generated\": " << m_world.generatedChunkCount - totals.generatedStart
+           << ", \"cached\": " << m_world.cachedChunkCount - totals.cachedStart
+           << ", \"stored\": " << m_world.storedChunkCount - totals.storedStart
+           << ", \"max_worker_queue\": " << totals.maxWorkerQueue << " },\n";
+    report << "  \"meshing\": { \"meshed\": " << m_world.meshedChunkCount - totals.meshedStart << " },\n";
+    report << "  \"uploads\": { \"tasks\": " << totals.uploadTasks << ", \"bytes\": " << totals.uploadBytes << ", \"ms\": " << totals.uploadMs << " },\n";
+    report << "  \"holes\": { \"mean\": " << static_cast<double>(totals.holes) / frames << ", \"max\": " << totals.maxHoles << " }\n";
+    report << "}\n";
+
+    std::cout << "Replay done, " << sorted.size() << " frames, p99 " << percentile(0.99f) << " ms, report in " << m_reportPath << std::endl;
+    return static_cast<bool>(report);
+}
+
 void Game::init() {
+    Profiler::setThreadName("Main");
+    m_startupTimeline.begin();
     initGlfw();
+    m_startupTimeline.mark("GLFW init");
     initGlad();
+    m_startupTimeline.mark("GLAD init");
     initThreadpool();
+    m_startupTimeline.mark("Threadpool init");
+    if (m_replaying) {
+        if (!m_flythrough.load(m_replayPath)) {
+            exit(-1);
+        }
+        FlythroughSample start = m_flythrough.sampleAt(0.0f);
+        m_player.position = start.position;
+        m_camera.yaw = start.yaw;
+        m_camera.pitch = start.pitch;
+        m_camera.updateFront();
+        m_player.creativeMode = true; // the path is followed exactly, no physics in between
+    }
     initWorld();
+    m_startupTimeline.mark("World init");
     initRenderer();
+    m_startupTimeline.mark("Renderer init");
 }
 
 void Game::run() {
@@ -328,16 +578,40 @@ void Game::run() {
     
     // The main game loop
     while (!glfwWindowShouldClose(m_window)) {
+        PROFILE_ZONE("Frame");
 
         float currentFrame = static_cast<float>(glfwGetTime());
         m_deltaTime = currentFrame - m_lastFrame;
         m_lastFrame = currentFrame;
+        float frameTime = m_deltaTime * 1000.0f; // before the clamp, hitches should show up in the percentiles
+        m_world.frameCounter++;
 
-        if (m_deltaTime > 0.02f) { 
-            m_deltaTime = 0.02f;
+        // the physics ticks catch up on real time, a stall (window drag, breakpoint) shouldnt turn into a jump
+        m_tickDeltaTime = std::min(m_deltaTime, m_maxFrameTime);
+        if (!m_player.creativeMode && !m_replaying) {
+            m_droppedTickTime += m_deltaTime - m_tickDeltaTime;
+        }
+        // everything else still moves per frame, keep that to a small step like before
+        if (m_deltaTime > m_maxDeltaTime) { 
+            m_deltaTime = m_maxDeltaTime;
         }
 
-        processInput();
+        if (m_replaying) {
+            m_deltaTime = m_replayTimestep;
+            m_tickDeltaTime = m_replayTimestep;
+        }
+
+        auto startInput = std::chrono::high_resolution_clock::now();
+        {
+            PROFILE_ZONE("Input");
+            if (m_replaying) {
+                updateReplay();
+            } else {
+                processInput();
+                updateRecording();
+            }
+        }
+        m_frameStats.addTime(SUBSYSTEM::INPUT, std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startInput).count());
 
         auto startUpdate = std::chrono::high_resolution_clock::now();
         update();
@@ -354,8 +628,18 @@ void Game::run() {
         m_renderTimes[m_timeIndex] = renderTime;
         size_t queueSize = m_threadpool.getWorkerQueueSize();
         m_queueSizes[m_timeIndex] = static_cast<float>(queueSize);
+        m_holeCounts[m_timeIndex] = static_cast<float>(m_renderer.frustumHoles);
         m_timeIndex = (m_timeIndex + 1) % 100;
 
+        float workTime = mainTime + renderTime - static_cast<float>(m_lastUploads.ms);
+        m_framePacing.endFrame(workTime, m_lastUploads.ms, m_lastUploads.bytes);
+        m_frameStats.endFrame(frameTime);
+        if (m_replaying) {
+            recordReplayFrame(frameTime);
+        }
+
+        updateStartupTimeline();
+
         glfwSwapBuffers(m_window);
         glfwPollEvents();
     }
@@ -363,6 +647,9 @@ void Game::run() {
 
 void Game::cleanup() {
     m_threadpool.cleanup();
+    if (m_writeTraceOnExit && !Profiler::writeChromeTrace(m_tracePath)) {
+        std::cerr << "Failed to write profiling trace to " << m_tracePath << std::endl;
+    }
     m_world.cleanup();
     m_renderer.cleanup();    
     glfwTerminate();
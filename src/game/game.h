@@ -8,11 +8,17 @@
 #include <stb/stb_image.h>
 #include <core/camera.h>
 #include <core/input_manager.h>
+#include <core/startup_timeline.h>
+#include <core/frame_pacing.h>
+#include <core/frame_stats.h>
+#include <core/profiler.h>
 #include <player/player.h>
 #include <physics/collision.h>
 #include <physics/physics.h>
+#include <physics/raycast.h>
 #include <world/world.h>
 #include <renderer/renderer.h>
+#include <game/flythrough.h>
 
 
 class Game {
@@ -21,6 +27,9 @@ public:
     void run();
     void cleanup();
 
+    // play a recorded flythrough instead of taking input, write a JSON report and quit at its end (call before init)
+    void setReplay(const std::string& path, const std::string& reportPath, bool hiddenWindow);
+
 private:
     // Game Components
     Player m_player;
@@ -38,13 +47,71 @@ private:
     GLFWwindow* m_window = nullptr;
     float m_deltaTime = 0.0f;
     float m_lastFrame = 0.0f;
+    float m_lastSaveTime = 0.0f;
+    const float m_saveInterval = 5.0f; // seconds between background saves of edited chunks
+
+    // Startup milestones, from init until everything in render distance is on the GPU
+    StartupTimeline m_startupTimeline;
+    bool m_startupReported = false;
+
+    // Frame pacing, sizes the main thread upload budget from the measured frame work
+    FramePacing m_framePacing;
+    MainTaskStats m_lastUploads; // main thread tasks run during this frames update
+    FrameStats m_frameStats;
+
+    // Flythrough, F4 starts/stops recording the camera path
+    Flythrough m_flythrough;
+    bool m_recording = false;
+    float m_recordStart = 0.0f;
+    const char* m_recordPath = "flythrough.txt";
+
+    // Replay, fixed timestep so every run simulates the same frames
+    bool m_replaying = false;
+    bool m_hiddenWindow = false;
+    std::string m_replayPath;
+    std::string m_reportPath;
+    const float m_replayTimestep = 1.0f / 60.0f;
+    bool m_replayStarted = false; // waits for the world around the start to load
+    float m_replayTime = 0.0f;
+    struct ReplayTotals {
+        std::vector<float> frameTimes;
+        float subsystemTimes[static_cast<int>(SUBSYSTEM::COUNT)] = {0};
+        double uploadMs = 0.0;
+        size_t uploadBytes = 0;
+        long long uploadTasks = 0;
+        long long holes = 0;
+        int maxHoles = 0;
+        size_t maxWorkerQueue = 0;
+        int generatedStart = 0, cachedStart = 0, storedStart = 0, meshedStart = 0;
+        float startupMs = 0.0f;
+    } m_replayTotals;
+
+    // Profiling, F3 writes the recorded zones as a Chrome trace
+    const char* m_tracePath = "trace.json";
+    const bool m_writeTraceOnExit = false;
 
     float m_updateTimes[100] = {0};
     float m_renderTimes[100] = {0};
     float m_queueSizes[100] = {0};
+    float m_holeCounts[100] = {0};
     int m_timeIndex = 0;    
     
     bool m_playerMovedChunks = false; 
+    glm::vec3 m_lastPlayerPosition = glm::vec3(0);
+    glm::vec3 m_playerVelocity = glm::vec3(0); // smoothed, drives the directional chunk prefetch
+
+    // Fixed timestep physics, ticks at 60 Hz whatever the frame rate and the camera is interpolated between the last two ticks
+    const float m_tickTime = 1.0f / 60.0f;
+    const int m_maxTicksPerFrame = 5;
+    const float m_maxFrameTime = 0.25f;               // cap on the real time the ticks catch up on
+    const float m_maxDeltaTime = 0.02f;               // cap on m_deltaTime, for the per frame movement (creative, velocity smoothing)
+    float m_tickDeltaTime = 0.0f;                     // this frames time for the tick accumulator
+    float m_tickAccumulator = 0.0f;
+    int m_lastTickCount = 0;                          // shown in the debug window
+    float m_droppedTickTime = 0.0f;                   // real time the ticks never caught up on, from either cap, for the debug window
+    glm::vec3 m_walkVelocity = glm::vec3(0);          // blocks/s from processInput, applied every tick
+    glm::vec3 m_previousTickPosition = glm::vec3(0);  // player position before the last tick
+    glm::vec3 m_renderPosition = glm::vec3(0);        // interpolated, what the camera follows
     bool m_wireframe = false;
 
     // Raycasting State (as per your request)
@@ -53,19 +120,18 @@ private:
     int m_curBlockType = 1; // Default block type dirt
 
     // Raycasting Configuration
-    const float m_rayStart = 0.1f;
     const float m_rayEnd = 4.0f;
-    const float m_rayStep = 0.1f;
-    const std::vector<glm::vec3> m_rayStarts = {
-        glm::vec3(0), glm::vec3(0.05f, 0, 0), glm::vec3(-0.05f, 0, 0),
-        glm::vec3(0, 0.05f, 0), glm::vec3(0, -0.05f, 0), glm::vec3(0, 0, 0.05f),
-        glm::vec3(0, 0, -0.05f)
-    };
+    const float m_creativeRayEnd = 64.0f; // reach in creative mode
 
     // Core Methods
     void processInput(); // maybe move to InputManager?
     void update();
     void render();
+    void updateStartupTimeline();
+    void updateRecording();
+    void updateReplay(); // sets the pose for this frame, or ends the replay
+    void recordReplayFrame(float frameTime);
+    bool writeReplayReport();
 
 
     // Logic Methods
@@ -1,14 +1,33 @@
 #include <game/game.h>
 #include <iostream>
+#include <string>
 
 
-int main() {
+int main(int argc, char** argv) {
     Game game;
-    std::cout<<"Constructor";
+
+    // --replay <path> [--report <path>] [--hidden]   plays a recorded flythrough (F4 records one) and quits
+    std::string replayPath, reportPath = "replay_report.json";
+    bool hidden = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (arg == "--report" && i + 1 < argc) {
+            reportPath = argv[++i];
+        } else if (arg == "--hidden") {
+            hidden = true;
+        } else {
+            std::cerr << "usage: minecraft_clone [--replay <flythrough> [--report <json>] [--hidden]]" << std::endl;
+            return 1;
+        }
+    }
+    if (!replayPath.empty()) {
+        game.setReplay(replayPath, reportPath, hidden);
+    }
+
     game.init();
-    std::cout<<"init";    
     game.run();
-    std::cout<<"run";    
     game.cleanup();
     return 0;
 }
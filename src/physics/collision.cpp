@@ -1,6 +1,9 @@
 #include <physics/collision.h>
 #include <world/world.h>
 #include <player/player.h>
+#include <core/utils.h>
+#include <algorithm>
+#include <cmath>
 
 
 bool Collision::boxBoxOverlap(const BoundingBox& box1, const BoundingBox& box2) const {
@@ -9,138 +12,145 @@ bool Collision::boxBoxOverlap(const BoundingBox& box1, const BoundingBox& box2)
            (box1.min.z <= box2.max.z && box1.max.z >= box2.min.z);
 }
 
-glm::vec3 Collision::resolveYCollision(glm::vec3 nextPlayerPos, glm::vec3 yMovement, World& world, Player& player) {
-    BoundingBox playerBox = BoundingBox::box(
-        nextPlayerPos + glm::vec3(0.0f, player.height / 2.0f, 0.0f),
-        player.width,
-        player.height,
-        player.depth
-    );
-    
-    int max_x = static_cast<int>(glm::ceil(playerBox.max.x + collisionMargin));
-    int max_y = static_cast<int>(glm::ceil(playerBox.max.y + collisionMargin));
-    int max_z = static_cast<int>(glm::ceil(playerBox.max.z + collisionMargin));
-    int min_x = static_cast<int>(glm::floor(playerBox.min.x - collisionMargin));
-    int min_y = static_cast<int>(glm::floor(playerBox.min.y - collisionMargin));
-    int min_z = static_cast<int>(glm::floor(playerBox.min.z - collisionMargin));
-
-    player.onGround = false;
-
-    for (int x = min_x; x < max_x; x++) {
-        for (int y = min_y; y < max_y; y++) {
-            for (int z = min_z; z < max_z; z++) {
-                Block* block = world.getBlock(glm::ivec3(x, y, z));
-                if (block && block->type != 0) {
-                    BoundingBox blockBox = BoundingBox::box(
-                        glm::vec3(x, y, z),
-                        BLOCK_SIZE,
-                        BLOCK_SIZE + 2.0f * collisionGap,
-                        BLOCK_SIZE
-                    );
-
-                    if (boxBoxOverlap(playerBox, blockBox)) {
-                        player.velocityY = 0.0f;
-                        if (yMovement.y > 0) { // Moving up
-                            nextPlayerPos.y = blockBox.min.y - player.height;
-                        } else { // Moving down
-                            nextPlayerPos.y = blockBox.max.y;
-                            player.onGround = true;
-                        }
-                        return nextPlayerPos; // Collision handled
-                    }
-                }
-            }
+// blocks are centred on integers, so cell p spans [p-0.5, p+0.5]
+static int cellOf(float coordinate) {
+    return static_cast<int>(std::floor(coordinate + 0.5f));
+}
+
+void Collision::moveAndCollide(World& world, Player& player, glm::vec3 movement) {
+    glm::bvec3 blocked(false);
+    {
+        std::shared_lock<std::shared_mutex> lock(world.chunkMapMutex);
+        player.position = moveBox(world, player.position, glm::vec3(player.width, player.height, player.depth), movement, blocked, player.onGround);
+    }
+    if (blocked.y) {
+        player.velocityY = 0.0f; // landed or hit its head
+    }
+}
+
+glm::vec3 Collision::moveBox(World& world, glm::vec3 position, glm::vec3 size, glm::vec3 movement, glm::bvec3& blocked, bool& onGround) {
+    glm::vec3 absMovement = glm::abs(movement);
+    int steps = std::max(1, static_cast<int>(std::ceil(std::max({absMovement.x, absMovement.y, absMovement.z}) / MAX_STEP)));
+    glm::vec3 stepMovement = movement / static_cast<float>(steps);
+
+    blocked = glm::bvec3(false);
+    onGround = false;
+    for (int i = 0; i < steps; i++) {
+        BoundingBox box = BoundingBox::box(position + glm::vec3(0.0f, size.y / 2.0f, 0.0f), size.x, size.y, size.z);
+
+        // falling (or standing) also probes a little further down, that keeps onGround steady while standing still
+        glm::vec3 reach = stepMovement;
+        if (reach.y <= 0.0f) {
+            reach.y -= GROUND_PROBE;
+        }
+        gatherSolidCells(world,
+                         glm::ivec3(cellOf(box.min.x + std::min(reach.x, 0.0f)), cellOf(box.min.y + std::min(reach.y, 0.0f)), cellOf(box.min.z + std::min(reach.z, 0.0f))) - 1,
+                         glm::ivec3(cellOf(box.max.x + std::max(reach.x, 0.0f)), cellOf(box.max.y + std::max(reach.y, 0.0f)), cellOf(box.max.z + std::max(reach.z, 0.0f))) + 1);
+
+        // Y
+        float moveY = sweepAxis(1, box, reach.y);
+        if (reach.y <= 0.0f && moveY > reach.y) {
+            onGround = true; // snaps onto the ground when its within the probe
+            blocked.y = true;
+            stepMovement.y = 0.0f;
+        } else if (reach.y > 0.0f && moveY < reach.y) {
+            blocked.y = true; // head hit a block
+            stepMovement.y = 0.0f;
+        } else {
+            moveY = stepMovement.y; // nothing within the probe, the probe itself isnt movement
+        }
+        box.min.y += moveY;
+        box.max.y += moveY;
+
+        // X
+        float moveX = sweepAxis(0, box, stepMovement.x);
+        if (moveX != stepMovement.x) {
+            blocked.x = true;
+        }
+        box.min.x += moveX;
+        box.max.x += moveX;
+
+        // Z
+        float moveZ = sweepAxis(2, box, stepMovement.z);
+        if (moveZ != stepMovement.z) {
+            blocked.z = true;
         }
+
+        position += glm::vec3(moveX, moveY, moveZ);
     }
-    return nextPlayerPos; // No collision
+    return position;
 }
 
-glm::vec3 Collision::resolveXZCollision(glm::vec3 nextPlayerPos, glm::vec3 xzMovement, World& world, Player& player) {
-
-    glm::vec3 resolvedPos = nextPlayerPos;
-
-    // Resolve X-axis collision
-    if (xzMovement.x != 0) {
-        BoundingBox playerBoxX = BoundingBox::box(
-            glm::vec3(resolvedPos.x, player.position.y + player.height / 2.0f, player.position.z),
-            player.width,
-            player.height,
-            player.depth
-        );
-
-        int max_x = static_cast<int>(glm::ceil(playerBoxX.max.x + collisionMargin));
-        int max_y = static_cast<int>(glm::ceil(playerBoxX.max.y + collisionMargin));
-        int max_z = static_cast<int>(glm::ceil(playerBoxX.max.z + collisionMargin));
-        int min_x = static_cast<int>(glm::floor(playerBoxX.min.x - collisionMargin));
-        int min_y = static_cast<int>(glm::floor(playerBoxX.min.y - collisionMargin));
-        int min_z = static_cast<int>(glm::floor(playerBoxX.min.z - collisionMargin));
-
-        for (int x = min_x; x < max_x; x++) {
-            for (int y = min_y; y < max_y; y++) {
-                for (int z = min_z; z < max_z; z++) {
-                    if (world.getBlock({x, y, z}) && world.getBlock({x, y, z})->type != 0) {
-                        BoundingBox blockBox = BoundingBox::box(
-                            glm::vec3(x, y, z),
-                            BLOCK_SIZE + 2.0f * collisionGap,
-                            BLOCK_SIZE,
-                            BLOCK_SIZE
-                        );
-                        if (boxBoxOverlap(playerBoxX, blockBox)) {
-                            if (xzMovement.x > 0) { // Moving right
-                                resolvedPos.x = blockBox.min.x - player.width / 2;
-                            } else { // Moving left
-                                resolvedPos.x = blockBox.max.x + player.width / 2;
-                            }
-                            goto resolve_z; // Move to Z resolution, cause at a time we can only have one collisoin along an axis, which is the closest to the player same for z
-                        }
-                    }
+void Collision::gatherSolidCells(World& world, glm::ivec3 min, glm::ivec3 max) {
+    m_gridMin = min;
+    m_gridSize = max - min + 1;
+    m_cells.assign(static_cast<size_t>(m_gridSize.x) * m_gridSize.y * m_gridSize.z, 0);
+
+    glm::ivec3 chunkOrigin(INT_MAX);
+    const Chunk* chunk = nullptr;
+    size_t index = 0;
+    for (int x = min.x; x <= max.x; x++) {
+        for (int y = min.y; y <= max.y; y++) {
+            for (int z = min.z; z <= max.z; z++, index++) {
+                glm::ivec3 origin(chunkOriginOf(x), chunkOriginOf(y), chunkOriginOf(z));
+                if (origin != chunkOrigin) {
+                    chunkOrigin = origin;
+                    chunk = world.getChunk(origin);
+                }
+                // missing chunks are air, same as the raycast
+                if (chunk) {
+                    m_cells[index] = chunk->isSolid(localOf(x), localOf(y), localOf(z));
                 }
             }
         }
     }
+}
+
+bool Collision::isSolid(int x, int y, int z) const {
+    glm::ivec3 local = glm::ivec3(x, y, z) - m_gridMin;
+    if (local.x < 0 || local.y < 0 || local.z < 0 || local.x >= m_gridSize.x || local.y >= m_gridSize.y || local.z >= m_gridSize.z) {
+        return false;
+    }
+    return m_cells[(static_cast<size_t>(local.x) * m_gridSize.y + local.y) * m_gridSize.z + local.z];
+}
 
-resolve_z:
-    // Resolve Z-axis collision
-    if (xzMovement.z != 0) {
-        BoundingBox playerBoxZ = BoundingBox::box(
-            glm::vec3(resolvedPos.x, player.position.y + player.height / 2.0f, resolvedPos.z),
-            player.width,
-            player.height,
-            player.depth
-        );
-
-        int max_x = static_cast<int>(glm::ceil(playerBoxZ.max.x + collisionMargin));
-        int max_y = static_cast<int>(glm::ceil(playerBoxZ.max.y + collisionMargin));
-        int max_z = static_cast<int>(glm::ceil(playerBoxZ.max.z + collisionMargin));
-        int min_x = static_cast<int>(glm::floor(playerBoxZ.min.x - collisionMargin));
-        int min_y = static_cast<int>(glm::floor(playerBoxZ.min.y - collisionMargin));
-        int min_z = static_cast<int>(glm::floor(playerBoxZ.min.z - collisionMargin));
-
-        for (int x = min_x; x < max_x; x++) {
-            for (int y = min_y; y < max_y; y++) {
-                for (int z = min_z; z < max_z; z++) {
-                    if (world.getBlock({x, y, z}) && world.getBlock({x, y, z})->type != 0) {
-                        BoundingBox blockBox = BoundingBox::box(
-                            glm::vec3(x, y, z),
-                            BLOCK_SIZE,
-                            BLOCK_SIZE,
-                            BLOCK_SIZE + 2.0f * collisionGap
-                        );
-                        if (boxBoxOverlap(playerBoxZ, blockBox)) {
-                            if (xzMovement.z > 0) { // Moving forward
-                                resolvedPos.z = blockBox.min.z - player.depth / 2;
-                            } else { // Moving backward
-                                resolvedPos.z = blockBox.max.z + player.depth / 2;
-                            }
-                            goto end_resolve;
-                        }
-                    }
+float Collision::sweepAxis(int axis, const BoundingBox& box, float distance) const {
+    if (distance == 0.0f) {
+        return 0.0f;
+    }
+    int a = (axis + 1) % 3;
+    int b = (axis + 2) % 3;
+    int minA = cellOf(box.min[a] + OVERLAP_EPSILON), maxA = cellOf(box.max[a] - OVERLAP_EPSILON);
+    int minB = cellOf(box.min[b] + OVERLAP_EPSILON), maxB = cellOf(box.max[b] - OVERLAP_EPSILON);
+
+    auto layerIsSolid = [&](int p) {
+        glm::ivec3 cell;
+        cell[axis] = p;
+        for (cell[a] = minA; cell[a] <= maxA; cell[a]++) {
+            for (cell[b] = minB; cell[b] <= maxB; cell[b]++) {
+                if (isSolid(cell.x, cell.y, cell.z)) {
+                    return true;
                 }
             }
         }
+        return false;
+    };
+
+    // walk the layers of cells ahead of the leading face, nearest first, cells the box already overlaps are ignored so it can get out of them
+    if (distance > 0.0f) {
+        float face = box.max[axis];
+        for (int p = static_cast<int>(std::ceil(face + 0.5f - OVERLAP_EPSILON)); p - 0.5f < face + distance; p++) {
+            if (layerIsSolid(p)) {
+                return std::max(0.0f, p - 0.5f - face);
+            }
+        }
+    } else {
+        float face = box.min[axis];
+        for (int p = static_cast<int>(std::floor(face - 0.5f + OVERLAP_EPSILON)); p + 0.5f > face + distance; p--) {
+            if (layerIsSolid(p)) {
+                return std::min(0.0f, p + 0.5f - face);
+            }
+        }
     }
-
-end_resolve:
-    return resolvedPos;
+    return distance;
 }
-
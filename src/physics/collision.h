@@ -2,6 +2,8 @@
 
 #include <glm/glm.hpp>
 #include <core/constants.h>
+#include <vector>
+#include <sys/types.h>
 
 
 // Forward Declarations
@@ -25,11 +27,28 @@ struct BoundingBox {
 class Collision {
     public:        
         bool boxBoxOverlap(const BoundingBox& playerBox, const BoundingBox& blockBox) const;
-        glm::vec3 resolveYCollision(glm::vec3 nextPlayerPos, glm::vec3 yMovement, World& world, Player& player);
-        glm::vec3 resolveXZCollision(glm::vec3 nextPlayerPos, glm::vec3 xzMovement, World& world, Player& player);
+
+        // Swept AABB, moves the player by movement and stops each axis (y, then x, then z) at the first solid block in the way.
+        // The whole distance is swept so nothing is skipped at any speed, long moves are split into steps to keep the gathered area small.
+        // Sets onGround (with a small snap down onto ground just below) and zeroes velocityY when the vertical move hits something
+        void moveAndCollide(World& world, Player& player, glm::vec3 movement);
+
+        // the same sweep for any box, position is the bottom centre. blocked is set per axis that hit something
+        // the caller holds chunkMapMutex (shared), so many boxes can be moved under one lock. Not thread safe, use one Collision per thread
+        glm::vec3 moveBox(World& world, glm::vec3 position, glm::vec3 size, glm::vec3 movement, glm::bvec3& blocked, bool& onGround);
         
     private:
-        // Collision constants 
-        const float collisionGap = 0.01f; 
-        const float collisionMargin = 0.5f; 
-};
\ No newline at end of file
+        // Collision constants 
+        static constexpr float OVERLAP_EPSILON = 1e-4f; // faces that only touch dont block the other axes
+        static constexpr float GROUND_PROBE = 0.01f;    // ground this close below still counts as standing on it
+        static constexpr float MAX_STEP = 8.0f;         // blocks per axis per step
+
+        // solidity of the cells around one step, copied out of the chunk masks under a single lock
+        std::vector<u_int8_t> m_cells;
+        glm::ivec3 m_gridMin = glm::ivec3(0);
+        glm::ivec3 m_gridSize = glm::ivec3(0);
+
+        void gatherSolidCells(World& world, glm::ivec3 min, glm::ivec3 max); // the caller holds chunkMapMutex
+        bool isSolid(int x, int y, int z) const;
+        float sweepAxis(int axis, const BoundingBox& box, float distance) const; // how far the box can move along axis, up to distance
+};
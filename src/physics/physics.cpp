@@ -3,7 +3,7 @@
 #include <player/player.h>
 
 
-void Physics::updatePhysics(Player& player, Collision& collision, World& world, float deltaTime, bool& playerMovedChunks) {
+void Physics::updatePhysics(Player& player, Collision& collision, World& world, float deltaTime, glm::vec3 xzMovement, bool& playerMovedChunks) {
     // Apply gravity if not on the ground
     if (!player.onGround) {
         player.velocityY -= player.gravity * deltaTime;
@@ -13,11 +13,10 @@ void Physics::updatePhysics(Player& player, Collision& collision, World& world,
         }
     }
 
-    glm::vec3 y_movement = glm::vec3(0.0f, player.velocityY * deltaTime, 0.0f);
-    glm::vec3 nextPlayerPosition = player.position + y_movement;
-    
+    glm::vec3 movement = glm::vec3(xzMovement.x, player.velocityY * deltaTime, xzMovement.z);
+
     glm::vec3 oldPos = player.position;
-    player.position = collision.resolveYCollision(nextPlayerPosition, y_movement, world, player);
+    collision.moveAndCollide(world, player, movement);
 
     // Check if player crossed a chunk boundary after physics update
     if (world.getChunkOrigin(player.position) != world.getChunkOrigin(oldPos)) {
@@ -8,5 +8,6 @@ struct Player;
 class Collision;
 
 struct Physics {
-    void updatePhysics( Player& player, Collision& collision, World& world, float deltaTime, bool& playerMovedChunks ) ;
+    // gravity plus the walking movement of this frame, all three axes go through one swept collision
+    void updatePhysics( Player& player, Collision& collision, World& world, float deltaTime, glm::vec3 xzMovement, bool& playerMovedChunks ) ;
 };
\ No newline at end of file
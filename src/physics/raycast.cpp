@@ -0,0 +1,120 @@
+#include <physics/raycast.h>
+#include <world/world.h>
+#include <threadpool/threadpool.h>
+#include <core/profiler.h>
+#include <core/utils.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+
+// rays per threadpool range, enough that the lock and task overhead disappear next to the traversals
+static constexpr size_t RAYS_PER_RANGE = 256;
+
+// the caller holds chunkMapMutex
+static RaycastHit traverse(World& world, glm::vec3 origin, glm::vec3 direction, float maxDistance) {
+    RaycastHit result;
+    if (glm::dot(direction, direction) == 0.0f) {
+        return result;
+    }
+    direction = glm::normalize(direction);
+
+    // shift by half a block so cell boundaries land on integers
+    glm::vec3 start = origin + glm::vec3(0.5f);
+    glm::ivec3 cell = glm::ivec3(glm::floor(start));
+    glm::ivec3 step;
+    glm::vec3 tMax;     // ray distance to the next boundary on each axis
+    glm::vec3 tDelta;   // ray distance between boundaries on each axis
+
+    const float infinity = std::numeric_limits<float>::infinity();
+    for (int axis = 0; axis < 3; axis++) {
+        if (direction[axis] > 0.0f) {
+            step[axis] = 1;
+            tDelta[axis] = 1.0f / direction[axis];
+            tMax[axis] = (std::floor(start[axis]) + 1.0f - start[axis]) * tDelta[axis];
+        } else if (direction[axis] < 0.0f) {
+            step[axis] = -1;
+            tDelta[axis] = -1.0f / direction[axis];
+            tMax[axis] = (start[axis] - std::floor(start[axis])) * tDelta[axis];
+        } else {
+            step[axis] = 0;
+            tDelta[axis] = infinity;
+            tMax[axis] = infinity;
+        }
+    }
+
+    // the cell is tracked relative to its chunk, the chunk is only looked up again once the ray leaves it
+    glm::ivec3 chunkOrigin = chunkOriginOf(cell);
+    glm::ivec3 local = localOf(cell);
+    const Chunk* chunk = world.getChunk(chunkOrigin);
+    if (chunk && chunk->solidCount == 0) {
+        chunk = nullptr;
+    }
+    glm::ivec3 normal(0);
+    float distance = 0.0f;
+
+    while (distance <= maxDistance) {
+        if (chunk && chunk->isSolid(local.x, local.y, local.z)) {
+            result.hit = true;
+            result.block = chunkOrigin + local;
+            result.normal = normal;
+            result.previous = (normal != glm::ivec3(0)) ? result.block + normal : glm::ivec3(INT_MAX);
+            result.distance = distance;
+            return result;
+        }
+
+        // step across the closest boundary
+        int axis = (tMax.x < tMax.y) ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+        distance = tMax[axis];
+        tMax[axis] += tDelta[axis];
+        local[axis] += step[axis];
+        normal = glm::ivec3(0);
+        normal[axis] = -step[axis];
+
+        if (local[axis] < 0 || local[axis] >= CHUNK_SIZE) {
+            chunkOrigin[axis] += step[axis] * CHUNK_SIZE;
+            local[axis] -= step[axis] * CHUNK_SIZE;
+            chunk = world.getChunk(chunkOrigin);
+            if (chunk && chunk->solidCount == 0) {
+                chunk = nullptr; // all air, nothing to test until the next chunk
+            }
+        }
+    }
+    return result;
+}
+
+RaycastHit raycastBlocks(World& world, glm::vec3 origin, glm::vec3 direction, float maxDistance) {
+    std::shared_lock<std::shared_mutex> lock(world.chunkMapMutex);
+    return traverse(world, origin, direction, maxDistance);
+}
+
+void raycastBlocksBatch(World& world, const Ray* rays, size_t count, RaycastHit* hits, Threadpool* threadpool) {
+    PROFILE_ZONE("raycastBlocksBatch");
+
+    // sorted by starting chunk (x, z, then y packed into one key), so a range mostly walks the same few chunks and keeps their masks in cache
+    std::vector<u_int64_t> order(count);
+    for (size_t i = 0; i < count; i++) {
+        glm::ivec3 cell = glm::ivec3(glm::floor(rays[i].origin + glm::vec3(0.5f)));
+        u_int64_t x = static_cast<u_int32_t>(chunkIndexOf(cell.x) + 0x800) & 0xfff;
+        u_int64_t z = static_cast<u_int32_t>(chunkIndexOf(cell.z) + 0x800) & 0xfff;
+        u_int64_t y = static_cast<u_int32_t>(chunkIndexOf(cell.y) + 0x80) & 0xff;
+        order[i] = (x << 52) | (z << 40) | (y << 32) | i;
+    }
+    std::sort(order.begin(), order.end());
+
+    auto castRange = [&](size_t begin, size_t end) {
+        std::shared_lock<std::shared_mutex> lock(world.chunkMapMutex);
+        for (size_t i = begin; i < end; i++) {
+            u_int32_t index = static_cast<u_int32_t>(order[i]);
+            const Ray& ray = rays[index];
+            hits[index] = traverse(world, ray.origin, ray.direction, ray.maxDistance);
+        }
+    };
+
+    if (threadpool) {
+        threadpool->parallelFor(count, RAYS_PER_RANGE, castRange);
+    } else {
+        castRange(0, count);
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <climits>
+#include <cstddef>
+
+
+// Forward Declarations
+class World;
+class Threadpool;
+
+// RAY
+struct Ray {
+    glm::vec3 origin = glm::vec3(0);
+    glm::vec3 direction = glm::vec3(0, 0, -1); // doesnt have to be normalized
+    float maxDistance = 0.0f;
+};
+
+// RAYCAST HIT
+struct RaycastHit {
+    bool hit = false;
+    glm::ivec3 block = glm::ivec3(INT_MAX);     // first solid block along the ray
+    glm::ivec3 normal = glm::ivec3(0);          // face the ray entered it through, zero when the ray started inside it
+    glm::ivec3 previous = glm::ivec3(INT_MAX);  // the empty cell in front of that face (block + normal), where a block would be placed
+    float distance = 0.0f;                      // along the ray to the entry point
+};
+
+// Exact voxel traversal (Amanatides & Woo), every cell the ray passes through is visited once, in order.
+// Blocks are unit cubes centred on their integer coordinates. Solidity comes from the chunk solid masks,
+// missing chunks and cells outside the world count as air
+RaycastHit raycastBlocks(World& world, glm::vec3 origin, glm::vec3 direction, float maxDistance); // takes the chunk map lock once
+
+// Many rays at once (line of sight, explosions, AI), hits[i] answers rays[i].
+// Rays are grouped by the chunk they start in and split into ranges over the threadpool (nullptr runs them all here),
+// each range holds the chunk map lock once. Blocks until every ray is done.
+// The sort only wins once the chunks the rays touch dont fit in cache (raycast_bench: ~25% faster on 40x40 columns,
+// ~10% slower than raycastBlocks on 24x24), single threaded over a small area the plain loop is as good
+void raycastBlocksBatch(World& world, const Ray* rays, size_t count, RaycastHit* hits, Threadpool* threadpool);
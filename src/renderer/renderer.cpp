@@ -79,17 +79,18 @@ void Renderer::initSelectedBlockObjects() {
     glBindVertexArray(0);
 }
 
-void Renderer::initWorldObjects(GLuint chunkVAO, GLuint chunkVBO, glm::ivec3 chunkCoord, World& world) {
-    glGenVertexArrays(1, &chunkVAO);
-    glGenBuffers(1, &chunkVBO);
-    world.chunkVaoMap[chunkCoord] = chunkVAO;
-    world.chunkVboMap[chunkCoord] = chunkVBO;
+void Renderer::initWorldObjects(ChunkRenderRecord& record) {
+    // the VAO is made once, a chunk whose sections outgrew their VBO gets a new one pointed at it (the caller deletes the old one)
+    if (record.vao == 0) {
+        glGenVertexArrays(1, &record.vao);
+    }
+    glGenBuffers(1, &record.vbo);
 
-    glBindVertexArray(chunkVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, chunkVBO);
+    glBindVertexArray(record.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, record.vbo);
 
     // Update vertex attribute pointers for the new 10-float stride
-    int stride = 10 * sizeof(float);
+    int stride = VERTEX_BYTES;
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
     glEnableVertexAttribArray(0); // Position
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
@@ -155,6 +156,12 @@ void Renderer::render(glm::ivec3 selectedBlock, Camera& camera, Player& player,
 
     totalVisibleChunks = 0;
     inFrustumChunks = 0;
+    frustumHoles = 0;
+
+    // culling first, then all the draws, so each is timed on its own
+    auto startCulling = std::chrono::high_resolution_clock::now();
+    drawList.clear();
+    frameIndex++;
     
     // here x y z order dont matter cause no array access, so x z y here is just
     for (int cx = -world.XZ_RENDER_DIST; cx <= world.XZ_RENDER_DIST; cx++) {
@@ -184,21 +191,34 @@ void Renderer::render(glm::ivec3 selectedBlock, Camera& camera, Player& player,
                     continue; // Skip
                 }                
                 
-                // Check if the chunk has a VAO and mesh data to render
-                auto vaoIt = world.chunkVaoMap.find(chunkOrigin);
-                if (vaoIt != world.chunkVaoMap.end()) {
-                    
-                    auto countIt = world.chunkVertexCountMap.find(chunkOrigin);
-                    if (countIt != world.chunkVertexCountMap.end()) {
-                        
-                        glBindVertexArray(vaoIt->second);
-                        glDrawArrays(GL_TRIANGLES, 0, countIt->second);
-                        inFrustumChunks++;
-                    }
+                // no record yet means the chunk isnt meshed, a hole in the view (empty chunks have a count of 0)
+                int recordIndex = world.findRenderRecord(chunkOrigin);
+                if (recordIndex < 0) {
+                    frustumHoles++;
+                    continue;
+                }
+
+                // the mesh bounds cull a bit more than the whole chunk, mostly chunks with just the surface in them
+                ChunkRenderRecord& record = world.chunkRenderRecords[recordIndex];
+                if (record.vertexCount > 0 && frustum.isBoxVisible(record.boundsMin, record.boundsMax)) {
+                    record.lastVisibleFrame = frameIndex;
+                    drawList.push_back(recordIndex);
                 }
             }
         }
     }
+    auto startDraw = std::chrono::high_resolution_clock::now();
+
+    for (int recordIndex : drawList) {
+        const ChunkRenderRecord& record = world.chunkRenderRecords[recordIndex];
+        glBindVertexArray(record.vao);
+        glMultiDrawArrays(GL_TRIANGLES, record.sectionFirst, record.sectionVertices, CHUNK_SECTIONS);
+    }
+    inFrustumChunks = static_cast<int>(drawList.size());
+
+    auto endDraw = std::chrono::high_resolution_clock::now();
+    cullingTime = std::chrono::duration<float, std::milli>(startDraw - startCulling).count();
+    drawTime = std::chrono::duration<float, std::milli>(endDraw - startDraw).count();
     
     // --- Render Selected Block Highlight ---
     if (selectedBlock != glm::ivec3(INT_MAX) && !player.creativeMode){
@@ -225,7 +245,7 @@ void Renderer::render(glm::ivec3 selectedBlock, Camera& camera, Player& player,
     }
 }
 
-void Renderer::renderImGui(Player& player, World& world, float* updateTimes, float* renderTimes, float* queueSizes, int timeIndex) {
+void Renderer::renderImGui(Player& player, World& world, float* updateTimes, float* renderTimes, float* queueSizes, float* holeCounts, int timeIndex, int tickCount, float droppedTickTime, StartupTimeline& startupTimeline, const FramePacing& framePacing, FrameStats& frameStats) {
     // Start the Dear ImGui frame
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
@@ -244,6 +264,10 @@ void Renderer::renderImGui(Player& player, World& world, float* updateTimes, flo
     glm::ivec3 pChunk = world.getChunkOrigin(glm::round(player.position));
     // Formatting the chunk coord to look like a vector
     ImGui::Text("  Chunk: [%d, %d, %d]", pChunk.x, pChunk.y, pChunk.z); 
+    glm::ivec3 pBlock = glm::round(player.position);
+    ImGui::Text("  Biome: %s", biomeParams[static_cast<int>(world.getBiome(pBlock.x, pBlock.z))].name);
+    // 0 tick frames are normal above 60 fps, its dropped time that means the physics fell behind
+    ImGui::Text("  Ticks: %d this frame, %.2f s dropped", tickCount, droppedTickTime);
     
     ImGui::Spacing();
     ImGui::Checkbox("Creative Mode", &player.creativeMode);
@@ -254,16 +278,85 @@ void Renderer::renderImGui(Player& player, World& world, float* updateTimes, flo
     ImGui::SeparatorText("Renderer");
     ImGui::Text("  Chunks: %d / %d", inFrustumChunks, totalVisibleChunks); // "Active / Total" format is cleaner
     ImGui::Text("  Culled: %d", totalVisibleChunks - inFrustumChunks);
+    ImGui::Text("  Holes:  %d", frustumHoles);
+    // click to the last remeshed section on the GPU
+    const EditStats& edits = world.editStats;
+    ImGui::Text("  Edits:  %.2f ms (avg %.2f, max %.2f), %.1f KB uploaded", edits.lastMs, edits.averageMs, edits.maxMs, edits.lastBytes / 1024.0f);
+    ImGui::Text("          visible %d same frame, %d next, %d later", edits.sameFrame, edits.nextFrame, edits.later);
+    ImGui::Text("          %d in place, %d regrown", edits.sectionUploads, edits.relayouts);
 
     // Profiling Graphs 
     ImGui::Spacing();
     ImGui::SeparatorText("Profiling"); // specific ImGui widget for headers
+    ImGui::Text("  Uploads: %.2f ms, %zu KB  (budget %.2f ms, %zu KB)", framePacing.getLastUploadMs(), framePacing.getLastUploadBytes() / 1024,
+                framePacing.getUploadBudgetMs(), framePacing.getUploadBudgetBytes() / 1024);
     // Make graphs slightly shorter (height=60) to save screen space
     ImGui::PlotLines("Main", updateTimes, 100, timeIndex, nullptr, 0.0f, 20.0f, ImVec2(300, 50));
 
     ImGui::PlotLines("Workers", queueSizes, 100, timeIndex, nullptr, 0.0f, FLT_MAX, ImVec2(300, 50));
     
     ImGui::PlotLines("Render", renderTimes, 100, timeIndex, nullptr, 0.0f, 20.0f, ImVec2(300, 50)); 
+
+    ImGui::PlotLines("Holes", holeCounts, 100, timeIndex, nullptr, 0.0f, FLT_MAX, ImVec2(300, 50));
+
+    // Frame Times, over the last FrameStats::WINDOW frames
+    ImGui::Spacing();
+    if (ImGui::CollapsingHeader("Frame Times")) {
+        ImGui::Text("  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms  (target %.2f)", frameStats.getP50(), frameStats.getP95(),
+                    frameStats.getP99(), frameStats.getMax(), framePacing.getTargetFrameMs());
+        ImGui::PlotHistogram("ms", frameStats.getHistogram(), FrameStats::HISTOGRAM_BINS, 0, "0 .. 50 ms", 0.0f, FLT_MAX, ImVec2(300, 60));
+
+        for (int i = 0; i < FrameStats::HITCH_THRESHOLDS; i++) {
+            ImGui::PushID(i);
+            ImGui::SetNextItemWidth(80);
+            ImGui::DragFloat("##threshold", &frameStats.hitchThresholdsMs[i], 0.5f, 1.0f, 1000.0f, "> %.1f ms");
+            ImGui::SameLine();
+            ImGui::Text("%d in window, %d total", frameStats.getWindowHitches(i), frameStats.getSessionHitches(i));
+            ImGui::PopID();
+        }
+        if (ImGui::Button("Reset hitches")) {
+            frameStats.resetHitches();
+        }
+
+        for (int i = 0; i < static_cast<int>(SUBSYSTEM::COUNT); i++) {
+            SUBSYSTEM subsystem = static_cast<SUBSYSTEM>(i);
+            ImGui::Text("  %-8s avg %6.3f  max %6.3f ms", subsystemNames[i], frameStats.getSubsystemAverage(subsystem), frameStats.getSubsystemMax(subsystem));
+        }
+    }
+
+    // Startup Timeline
+    ImGui::Spacing();
+    if (ImGui::CollapsingHeader("Startup")) {
+        int target = world.startupChunkTarget;
+        int ready = world.startupReadyChunks;
+        ImGui::ProgressBar(target > 0 ? static_cast<float>(ready) / target : 1.0f, ImVec2(300, 0));
+        ImGui::Text("  View: %d / %d chunks", ready, target);
+        for (const auto& event : startupTimeline.events()) {
+            ImGui::Text("  %8.1f ms  %s", event.ms, event.name.c_str());
+        }
+        if (ImGui::Button("Save to startup_timeline.txt")) {
+            startupTimeline.dump("startup_timeline.txt");
+        }
+    }
+
+    // Chunk Map, probe lengths of the open addressing table and the render records (only walked while the header is open)
+    ImGui::Spacing();
+    if (ImGui::CollapsingHeader("Chunk Map")) {
+        auto stats = world.getChunkMapStats();
+        ImGui::Text("  Chunks: %zu in %zu slots (%.0f%% full)", stats.size, stats.capacity, stats.capacity ? 100.0 * stats.size / stats.capacity : 0.0);
+        ImGui::Text("  Probe:  avg %.2f  max %zu", stats.averageProbe, stats.maxProbe);
+
+        // meshes that havent been drawn for a while are candidates for dropping from the GPU
+        constexpr u_int64_t STALE_FRAMES = 600;
+        int staleRecords = 0;
+        for (const ChunkRenderRecord& record : world.chunkRenderRecords) {
+            if (record.vertexCount > 0 && record.lastVisibleFrame + STALE_FRAMES < frameIndex) {
+                staleRecords++;
+            }
+        }
+        ImGui::Text("  Meshes: %zu records, %.1f MB, %d not drawn in %d frames", world.chunkRenderRecords.size(),
+                    world.chunkMeshBytes / (1024.0 * 1024.0), staleRecords, static_cast<int>(STALE_FRAMES));
+    }
     
     ImGui::End();
 
@@ -9,13 +9,21 @@
 #include <imgui/imgui_impl_glfw.h>
 #include <imgui/imgui_impl_opengl3.h>
 #include <core/constants.h>
+#include <core/startup_timeline.h>
+#include <core/frame_pacing.h>
+#include <core/frame_stats.h>
 #include <renderer/frustum.h>
+#include <memory>
+#include <chrono>
+#include <utility>
+#include <vector>
 
 
 // Forward Declarations
 struct Player;
 struct Camera;
 class World;
+struct ChunkRenderRecord;
 
 class Renderer {
     public:
@@ -26,22 +34,29 @@ class Renderer {
         // frustum culling stats
         int totalVisibleChunks = 0;
         int inFrustumChunks = 0;        
+        int frustumHoles = 0; // chunks in view and render distance that arent meshed yet
+
+        // main thread time of the last render() in ms
+        float cullingTime = 0.0f;
+        float drawTime = 0.0f;
 
         // Render Functions
         void render(glm::ivec3 selectedBlock, Camera& camera, Player& player, World& world, GLFWwindow* window); 
-        void renderImGui(Player& player, World& world, float* updateTimes, float* renderTimes, float* queueSizes, int timeIndex);         
+        void renderImGui(Player& player, World& world, float* updateTimes, float* renderTimes, float* queueSizes, float* holeCounts, int timeIndex, int tickCount, float droppedTickTime, StartupTimeline& startupTimeline, const FramePacing& framePacing, FrameStats& frameStats);         
         
         // Lifecycle
         void init(GLFWwindow* window);
         void cleanup();
         
         void initSelectedBlockObjects();  
-        void initWorldObjects(GLuint chunkVAO, GLuint chunkVBO, glm::ivec3 chunkCoord, World& world);
+        void initWorldObjects(ChunkRenderRecord& record);
 
     private:
         // Textures and Buffers
         GLuint textureAtlas;
         GLuint selectedBlockVao, selectedBlockVbo;   
+        std::vector<int> drawList; // render records of the chunks that passed culling, reused every frame
+        u_int64_t frameIndex = 0;  // stamped on the records that get drawn
 
         // Initialization Helpers
         void initShaders();
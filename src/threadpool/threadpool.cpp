@@ -1,9 +1,12 @@
 #include <threadpool/threadpool.h>
+#include <core/profiler.h>
+#include <algorithm>
 
 void Threadpool::init(){
     int numThreads = std::thread::hardware_concurrency()-1; // Leave 1 thread free for the main thread
     for(int i=0; i<numThreads; i++){
-        workerThreads.emplace_back([this]{
+        workerThreads.emplace_back([this, i]{
+            Profiler::setThreadName("Worker " + std::to_string(i));
             while(true){
                 std::function<void()> task;
                 {
@@ -12,8 +15,13 @@ void Threadpool::init(){
                     if(stopThreads) return; // Exit thread if stopping (Hard exit)
                     task = std::move(workerTaskQueue.front());
                     workerTaskQueue.pop_front();
+                    runningTasks++;
                 }
                 task(); // Execute the task
+                {
+                    std::lock_guard<std::mutex> lock(workerQueueMutex);
+                    runningTasks--;
+                }
             }
         });
     }
@@ -32,29 +40,62 @@ void Threadpool::cleanup(){
     }
 }
 
-void Threadpool::processMainThreadTasks(){
+MainTaskStats Threadpool::processMainThreadTasks(double budgetMs, size_t budgetBytes){
+    PROFILE_ZONE("Main thread tasks");
 
-    const double MAX_UPLOAD_TIME_MS = 2.0;
+    MainTaskStats stats;
     auto startTime = std::chrono::high_resolution_clock::now();
 
+    // priority tasks count against the budget but are never held back by it
+    runPriorityMainTasks(stats);
+    int bulkTasks = 0;
+
     while(true){
-        std::function<void()> task;
+        MainTask task;
         {
             std::lock_guard<std::mutex> lock(mainThreadQueueMutex);
             if(mainTaskQueue.empty()) break; // No more tasks to process
+
+            // bytes are checked before running, so a big upload waits for the next frame instead of overshooting this one
+            if (bulkTasks > 0 && stats.bytes + mainTaskQueue.front().bytes > budgetBytes) {
+                break;
+            }
             task = std::move(mainTaskQueue.front());
             mainTaskQueue.pop();
         }
-        task(); // Execute the task
+        task.task(); // Execute the task
+        stats.tasks++;
+        bulkTasks++;
+        stats.bytes += task.bytes;
 
         auto currentTime = std::chrono::high_resolution_clock::now();
-        double elapsedTime = std::chrono::duration<double, std::milli>(currentTime - startTime).count();
+        stats.ms = std::chrono::duration<double, std::milli>(currentTime - startTime).count();
 
         // If we ran out of time, stop uploading and save the rest for the next frame
-        if (elapsedTime >= MAX_UPLOAD_TIME_MS) {
+        if (stats.ms >= budgetMs) {
             break; 
         }        
     }
+
+    // the ones that finished on the workers while the bulk tasks ran still make it into this frame
+    runPriorityMainTasks(stats);
+    stats.ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+    return stats;
+}
+
+void Threadpool::runPriorityMainTasks(MainTaskStats& stats){
+    while(true){
+        MainTask task;
+        {
+            std::lock_guard<std::mutex> lock(mainThreadQueueMutex);
+            if(priorityMainTaskQueue.empty()) return;
+            task = std::move(priorityMainTaskQueue.front());
+            priorityMainTaskQueue.pop();
+        }
+        task.task();
+        stats.tasks++;
+        stats.bytes += task.bytes;
+    }
 }
 
 void Threadpool::enqueueBackWorkerTask(std::function<void()> task){
@@ -73,14 +114,70 @@ void Threadpool::enqueueFrontWorkerTask(std::function<void()> task){
     condition.notify_one(); // Notify one worker thread that there's a new task    
 }
 
+void Threadpool::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& fn){
+    if (count == 0) return;
+    grainSize = std::max<size_t>(grainSize, 1);
+    size_t ranges = (count + grainSize - 1) / grainSize;
+
+    // shared with the worker tasks, one that only gets to run after everything finished finds no range left and never touches fn
+    struct ParallelState {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<ParallelState>();
+    const std::function<void(size_t, size_t)>* body = &fn;
+
+    auto run = [state, body, count, grainSize]{
+        while (true) {
+            size_t begin = state->next.fetch_add(grainSize);
+            if (begin >= count) return;
+            size_t end = std::min(begin + grainSize, count);
+            (*body)(begin, end);
+            if (state->done.fetch_add(end - begin) + (end - begin) == count) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min(workerThreads.size(), ranges - 1);
+    for (size_t i = 0; i < helpers; i++) {
+        enqueueFrontWorkerTask(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&]{ return state->done.load() == count; });
+}
+
 size_t Threadpool::getWorkerQueueSize() {
     std::lock_guard<std::mutex> lock(workerQueueMutex);
     return workerTaskQueue.size();
 }
 
-void Threadpool::enqueueMainTask(std::function<void()> task){
+bool Threadpool::isIdle() {
+    {
+        std::lock_guard<std::mutex> lock(workerQueueMutex);
+        if (!workerTaskQueue.empty() || runningTasks > 0) {
+            return false;
+        }
+    }
+    std::lock_guard<std::mutex> lock(mainThreadQueueMutex);
+    return mainTaskQueue.empty() && priorityMainTaskQueue.empty();
+}
+
+void Threadpool::enqueueMainTask(std::function<void()> task, size_t bytes){
+    {
+        std::lock_guard<std::mutex> lock(mainThreadQueueMutex);
+        mainTaskQueue.push(MainTask{std::move(task), bytes});
+    }
+}
+
+void Threadpool::enqueuePriorityMainTask(std::function<void()> task, size_t bytes){
     {
         std::lock_guard<std::mutex> lock(mainThreadQueueMutex);
-        mainTaskQueue.push(std::move(task));
+        priorityMainTaskQueue.push(MainTask{std::move(task), bytes});
     }
-}
\ No newline at end of file
+}
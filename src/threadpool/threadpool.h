@@ -7,27 +7,54 @@
 #include <condition_variable>
 #include <functional>
 #include <shared_mutex>
+#include <queue>
+#include <cstddef>
+#include <string>
+#include <atomic>
+#include <memory>
 
 
+// what one processMainThreadTasks call got through
+struct MainTaskStats {
+    int tasks = 0;
+    size_t bytes = 0;
+    double ms = 0.0;
+};
+
 class Threadpool{
     public:
         void init();
         void cleanup();
-        void processMainThreadTasks();
+        // runs main thread tasks until either budget is spent, always at least one so the queue keeps moving
+        // priority tasks all run, before the others and again after them for the ones that got queued meanwhile
+        MainTaskStats processMainThreadTasks(double budgetMs, size_t budgetBytes);
         
         void enqueueBackWorkerTask(std::function<void()> task);
         void enqueueFrontWorkerTask(std::function<void()> task);
         size_t getWorkerQueueSize();
 
-        void enqueueMainTask(std::function<void()> task);        
+        // splits [0, count) into ranges of grainSize and runs fn(begin, end) on the workers and the calling thread, returns once all ranges ran
+        // the ranges go to the front of the worker queue, and the caller keeps taking ranges too, so it never waits on chunk generation
+        void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& fn);
+        bool isIdle(); // nothing queued or running on the workers, and no main thread tasks left
+
+        void enqueueMainTask(std::function<void()> task, size_t bytes = 0); // bytes it uploads, counted against the byte budget
+        void enqueuePriorityMainTask(std::function<void()> task, size_t bytes = 0); // not held back by the budget or queued bulk tasks (block edits)
         
     private:
         
         std::deque<std::function<void()>> workerTaskQueue;
         std::mutex workerQueueMutex;
+        int runningTasks = 0; // guarded by workerQueueMutex
         
-        std::queue<std::function<void()>> mainTaskQueue;
-        std::mutex mainThreadQueueMutex;        
+        struct MainTask {
+            std::function<void()> task;
+            size_t bytes;
+        };
+        std::queue<MainTask> mainTaskQueue;
+        std::queue<MainTask> priorityMainTaskQueue;
+        std::mutex mainThreadQueueMutex; // guards both main task queues
+        void runPriorityMainTasks(MainTaskStats& stats);
 
         std::vector<std::thread> workerThreads;       
         std::condition_variable condition;
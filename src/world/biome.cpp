@@ -0,0 +1,121 @@
+#include <world/biome.h>
+#include <algorithm>
+
+
+// 0 at 'from', 1 at 'to' (works in either direction), smoothed
+static float ramp(float x, float from, float to) {
+    float t = std::clamp((x - from) / (to - from), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+void BiomeMap::init(int seed) {
+    temperatureNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
+    temperatureNoise.SetSeed(seed + 1);
+    temperatureNoise.SetFrequency(0.0008f);
+
+    moistureNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
+    moistureNoise.SetSeed(seed + 2);
+    moistureNoise.SetFrequency(0.001f);
+
+    regionCache.clear();
+}
+
+BIOME BiomeMap::classify(float temperature, float moisture) {
+    // thresholds sit in the middle of the blend ramps in calculateRegion
+    if (temperature < -0.5f) return BIOME::SNOW;
+    if (temperature >  0.5f) return BIOME::DESERT;
+    if (moisture    < -0.3f) return BIOME::MOUNTAINS;
+    return BIOME::PLAINS;
+}
+
+std::shared_ptr<const BiomeMap::BiomeRegion> BiomeMap::calculateRegion(glm::ivec2 region) {
+    auto biomeRegion = std::make_shared<BiomeRegion>();
+
+    for (int i = 0; i < NODES_PER_SIDE; i++) {
+        for (int j = 0; j < NODES_PER_SIDE; j++) {
+            float globalX = static_cast<float>(region.x * REGION_SIZE + i * BIOME_GRID_SPACING);
+            float globalZ = static_cast<float>(region.y * REGION_SIZE + j * BIOME_GRID_SPACING);
+
+            BiomeNode& node = biomeRegion->nodes[i][j];
+            node.temperature = temperatureNoise.GetNoise(globalX, globalZ);
+            node.moisture = moistureNoise.GetNoise(globalX, globalZ);
+
+            // blend weights instead of a hard pick, so heights dont jump at biome borders
+            float cold = ramp(node.temperature, -0.4f, -0.6f);
+            float hot = ramp(node.temperature, 0.4f, 0.6f);
+            float rest = 1.0f - cold - hot; // cold and hot ramps never overlap
+            float mountainous = ramp(node.moisture, -0.2f, -0.4f);
+
+            float weights[4];
+            weights[static_cast<int>(BIOME::PLAINS)]    = rest * (1.0f - mountainous);
+            weights[static_cast<int>(BIOME::DESERT)]    = hot;
+            weights[static_cast<int>(BIOME::SNOW)]      = cold;
+            weights[static_cast<int>(BIOME::MOUNTAINS)] = rest * mountainous;
+
+            node.baseHeight = 0.0f;
+            node.heightScale = 0.0f;
+            for (int b = 0; b < 4; b++) {
+                node.baseHeight += weights[b] * biomeParams[b].baseHeight;
+                node.heightScale += weights[b] * biomeParams[b].heightScale;
+            }
+        }
+    }
+    return biomeRegion;
+}
+
+std::shared_ptr<const BiomeMap::BiomeRegion> BiomeMap::getRegion(glm::ivec2 region) {
+    std::shared_ptr<const BiomeRegion> biomeRegion;
+    if (regionCache.get(region, biomeRegion)) {
+        return biomeRegion;
+    }
+
+    biomeRegion = calculateRegion(region);
+    regionCache.put(region, biomeRegion);
+    return biomeRegion;
+}
+
+BiomeSample BiomeMap::interpolate(const BiomeRegion& region, int localX, int localZ) {
+    int cellX = localX / BIOME_GRID_SPACING;
+    int cellZ = localZ / BIOME_GRID_SPACING;
+    float fx = static_cast<float>(localX % BIOME_GRID_SPACING) / BIOME_GRID_SPACING;
+    float fz = static_cast<float>(localZ % BIOME_GRID_SPACING) / BIOME_GRID_SPACING;
+
+    const BiomeNode& n00 = region.nodes[cellX][cellZ];
+    const BiomeNode& n10 = region.nodes[cellX + 1][cellZ];
+    const BiomeNode& n01 = region.nodes[cellX][cellZ + 1];
+    const BiomeNode& n11 = region.nodes[cellX + 1][cellZ + 1];
+
+    auto bilerp = [fx, fz](float v00, float v10, float v01, float v11) {
+        float a = v00 + (v10 - v00) * fx;
+        float b = v01 + (v11 - v01) * fx;
+        return a + (b - a) * fz;
+    };
+
+    BiomeSample sample;
+    sample.temperature = bilerp(n00.temperature, n10.temperature, n01.temperature, n11.temperature);
+    sample.moisture    = bilerp(n00.moisture,    n10.moisture,    n01.moisture,    n11.moisture);
+    sample.baseHeight  = bilerp(n00.baseHeight,  n10.baseHeight,  n01.baseHeight,  n11.baseHeight);
+    sample.heightScale = bilerp(n00.heightScale, n10.heightScale, n01.heightScale, n11.heightScale);
+    sample.biome = classify(sample.temperature, sample.moisture);
+    return sample;
+}
+
+BiomeSample BiomeMap::sample(int x, int z) {
+    glm::ivec2 region(floorDiv(x, REGION_SIZE), floorDiv(z, REGION_SIZE));
+    std::shared_ptr<const BiomeRegion> biomeRegion = getRegion(region);
+    return interpolate(*biomeRegion, x - region.x * REGION_SIZE, z - region.y * REGION_SIZE);
+}
+
+void BiomeMap::sampleColumn(int chunkX, int chunkZ, BiomeSample samples[CHUNK_SIZE][CHUNK_SIZE]) {
+    // a chunk always sits inside a single region, so one cache lookup serves all 32x32 columns
+    glm::ivec2 region(floorDiv(chunkX, REGION_SIZE), floorDiv(chunkZ, REGION_SIZE));
+    std::shared_ptr<const BiomeRegion> biomeRegion = getRegion(region);
+
+    int localX = chunkX - region.x * REGION_SIZE;
+    int localZ = chunkZ - region.y * REGION_SIZE;
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            samples[x][z] = interpolate(*biomeRegion, localX + x, localZ + z);
+        }
+    }
+}
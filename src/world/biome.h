@@ -0,0 +1,85 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <FastNoiseLite/FastNoiseLite.h>
+#include <core/constants.h>
+#include <core/utils.h>
+#include <core/lru_cache.h>
+#include <memory>
+#include <sys/types.h>
+
+
+// BIOMES
+enum class BIOME: u_int8_t{
+    PLAINS      = 0,
+    DESERT      = 1,    // hot
+    SNOW        = 2,    // cold
+    MOUNTAINS   = 3,    // temperate and dry
+};
+
+// Terrain parameters of a biome
+struct BiomeParams {
+    const char* name;
+    float baseHeight;           // height = baseHeight + noise * heightScale
+    float heightScale;
+    u_int8_t surfaceBlock;      // top block of a column
+    u_int8_t subsurfaceBlock;   // the 5 blocks under it
+};
+
+inline constexpr BiomeParams biomeParams[4] = {
+    // name         base    scale   surface     subsurface
+    { "Plains",     64.0f,  30.0f,  1,          2 },    // Grass, Dirt
+    { "Desert",     62.0f,  15.0f,  4,          4 },    // Sand, Sand
+    { "Snow",       70.0f,  35.0f,  5,          2 },    // Snow, Dirt
+    { "Mountains",  72.0f,  60.0f,  3,          3 },    // Stone, Stone (snow capped, see World::calculateColumnSpans)
+};
+
+// Biome fields at one column, interpolated from the coarse grid
+struct BiomeSample {
+    float temperature;
+    float moisture;
+    float baseHeight;
+    float heightScale;
+    BIOME biome;
+};
+
+// BIOME MAP
+// temperature/moisture are very low frequency, so they are only evaluated on a coarse grid
+// (every BIOME_GRID_SPACING blocks) per region and bilinearly interpolated for each column
+class BiomeMap {
+    public:
+        static constexpr int REGION_SIZE = 128;          // blocks per region side, a multiple of CHUNK_SIZE so a chunk never straddles regions
+        static constexpr int BIOME_GRID_SPACING = 8;     // blocks between grid nodes
+        static constexpr int NODES_PER_SIDE = REGION_SIZE / BIOME_GRID_SPACING + 1; // +1 so the last cell has a far edge
+
+        void init(int seed);
+
+        BiomeSample sample(int x, int z);
+        void sampleColumn(int chunkX, int chunkZ, BiomeSample samples[CHUNK_SIZE][CHUNK_SIZE]); // every column of a chunk (x,z of the chunk origin)
+
+        static BIOME classify(float temperature, float moisture);
+
+    private:
+        // grid node, height parameters are blended at the node so biome borders interpolate smoothly
+        struct BiomeNode {
+            float temperature;
+            float moisture;
+            float baseHeight;
+            float heightScale;
+        };
+
+        struct BiomeRegion {
+            BiomeNode nodes[NODES_PER_SIDE][NODES_PER_SIDE];
+        };
+
+        FastNoiseLite temperatureNoise;
+        FastNoiseLite moistureNoise;
+
+        // a region covers 16 chunk columns, so a small cache covers the whole generation front
+        static constexpr size_t REGION_CACHE_SIZE = 256;
+        LruCache<glm::ivec2, std::shared_ptr<const BiomeRegion>> regionCache{REGION_CACHE_SIZE};
+
+        std::shared_ptr<const BiomeRegion> getRegion(glm::ivec2 region);
+        std::shared_ptr<const BiomeRegion> calculateRegion(glm::ivec2 region);
+        BiomeSample interpolate(const BiomeRegion& region, int localX, int localZ);
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <core/constants.h>
+#include <sys/types.h>
+
+
+// BLOCK
+struct Block{
+    u_int8_t type = 0;
+};
+
+
+// CHUNK STATE
+enum class CHUNK_STATE: u_int8_t{
+    EMPTY       = 0,    // No block data, not generated
+    GENERATED   = 1,    // Block data generated, no mesh
+    MESHED      = 2,    // Mesh generated and uploaded to GPU
+};
+
+// CHUNK
+struct Chunk {
+    Block blocks[CHUNK_SIZE][CHUNK_SIZE][CHUNK_SIZE];
+    CHUNK_STATE state = CHUNK_STATE::EMPTY; 
+    bool edited = false;    // blocks may differ from the generator output (player edits, region files), never goes in the chunk cache
+    bool cached = false;    // already in the chunk cache
+    bool meshBuilt = false; // first mesh done, later meshes are remeshes after edits
+    u_int32_t meshVersion = 0; // bumped for every mesh built, so an older mesh that reaches the main thread late cant replace a newer one
+
+    // bit z of solidMask[x][y] is set for non air blocks, a 4KB copy of the solidity for ray queries
+    // kept in sync by World (built before the chunk goes in the map, updated by setBlock)
+    u_int32_t solidMask[CHUNK_SIZE][CHUNK_SIZE] = {};
+    int solidCount = 0; // 0 lets rays cross the chunk without looking at it
+
+    bool isSolid(int x, int y, int z) const { return (solidMask[x][y] >> z) & 1u; }
+
+    void buildSolidMask() {
+        solidCount = 0;
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            for (int y = 0; y < CHUNK_SIZE; y++) {
+                u_int32_t row = 0;
+                for (int z = 0; z < CHUNK_SIZE; z++) {
+                    row |= static_cast<u_int32_t>(blocks[x][y][z].type != 0) << z;
+                }
+                solidMask[x][y] = row;
+                solidCount += __builtin_popcount(row);
+            }
+        }
+    }
+
+    void setSolid(int x, int y, int z, bool solid) {
+        u_int32_t bit = 1u << z;
+        if (static_cast<bool>(solidMask[x][y] & bit) == solid) {
+            return;
+        }
+        solidMask[x][y] ^= bit;
+        solidCount += solid ? 1 : -1;
+    }
+};
+static_assert(CHUNK_SIZE <= 32, "Chunk::solidMask rows are 32 bit");
+
+// PACKED FACE
+// one visible block face in 4 bytes, meshes are built in this form and only expanded to full vertices for upload
+// bits: x 0-4, y 5-9, z 10-14 (chunk local), face id 15-17, block type 18-25
+using PackedFace = u_int32_t;
+
+inline PackedFace packFace(int x, int y, int z, int faceID, u_int8_t type) {
+    return static_cast<PackedFace>(x | (y << 5) | (z << 10) | (faceID << 15)) | (static_cast<PackedFace>(type) << 18);
+}
+inline glm::ivec3 unpackFacePosition(PackedFace face) { return glm::ivec3(face & 31, (face >> 5) & 31, (face >> 10) & 31); }
+inline int unpackFaceID(PackedFace face) { return (face >> 15) & 7; }
+inline u_int8_t unpackFaceType(PackedFace face) { return (face >> 18) & 255; }
+
+
+// MESH SECTIONS
+// chunk meshes are split into horizontal slabs with their own vertex range, so a block edit only remeshes and reuploads
+// the slabs it touches. Slabs span whole x and z rows, which is what the bitmask mesher works on
+constexpr int SECTION_SHIFT = 3;
+constexpr int SECTION_HEIGHT = 1 << SECTION_SHIFT;
+constexpr int CHUNK_SECTIONS = CHUNK_SIZE / SECTION_HEIGHT;
+
+inline int unpackFaceSection(PackedFace face) { return ((face >> 5) & 31) >> SECTION_SHIFT; }
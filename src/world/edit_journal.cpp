@@ -0,0 +1,178 @@
+#include <world/edit_journal.h>
+#include <world/region.h>
+#include <world/world.h>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+
+EditJournal::~EditJournal() {
+    close();
+}
+
+bool EditJournal::open(const std::string& directory, int seed) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+
+    this->seed = seed;
+    std::string fileName = "edits." + std::to_string(seed) + "-v" + std::to_string(World::GENERATOR_VERSION) + ".journal";
+    path = (std::filesystem::path(directory) / fileName).string();
+    edits.clear();
+    liveEdits = 0;
+    fileRecords = 0;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    // load whatever is there, a torn record at the end (crash mid append) is dropped
+    FILE* existing = fopen(path.c_str(), "rb");
+    if (!existing && errno != ENOENT) {
+        // it may well hold edits, so leave it alone and dont journal this session
+        std::cerr << "Failed to read edit journal " << path << ": " << strerror(errno) << ", edits wont be saved" << std::endl;
+        return false;
+    }
+    if (existing) {
+        JournalHeader header;
+        bool accepted = fread(&header, sizeof(header), 1, existing) == 1 && header.magic == JOURNAL_MAGIC &&
+                        header.version == JOURNAL_VERSION && header.seed == seed &&
+                        header.generatorVersion == World::GENERATOR_VERSION;
+        if (accepted) {
+            JournalRecord record;
+            while (fread(&record, sizeof(record), 1, existing) == 1) {
+                if (record.index >= CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE) {
+                    continue;
+                }
+                auto& chunkEdits = edits[glm::ivec3(record.chunkX, record.chunkY, record.chunkZ)];
+                liveEdits -= chunkEdits.count(record.index);
+                chunkEdits[record.index] = record.type;
+                liveEdits++;
+            }
+        }
+        fclose(existing);
+
+        // compacting would overwrite it, keep the old file around instead
+        if (!accepted) {
+            std::cerr << "Rejected edit journal " << path << ", expected seed " << seed
+                      << ", generator version " << World::GENERATOR_VERSION << std::endl;
+            if (!moveFileAside(path)) {
+                std::cerr << "Edits wont be saved" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // always start from a compacted file, that also gets rid of any torn tail
+    return compact();
+}
+
+void EditJournal::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+void EditJournal::record(glm::ivec3 blockPosition, glm::ivec3 chunkOrigin, u_int8_t type) {
+    glm::ivec3 local = localOf(blockPosition);
+    JournalRecord record;
+    record.chunkX = chunkOrigin.x;
+    record.chunkY = chunkOrigin.y;
+    record.chunkZ = chunkOrigin.z;
+    record.index = static_cast<u_int16_t>(local.x * CHUNK_SIZE * CHUNK_SIZE + local.y * CHUNK_SIZE + local.z);
+    record.type = type;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& chunkEdits = edits[chunkOrigin];
+    liveEdits -= chunkEdits.count(record.index);
+    chunkEdits[record.index] = type;
+    liveEdits++;
+
+    // buffered by stdio, flush() pushes it out with the periodic save
+    if (file && fwrite(&record, sizeof(record), 1, file) == 1) {
+        fileRecords++;
+    }
+}
+
+void EditJournal::apply(glm::ivec3 chunkOrigin, Chunk& chunk) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = edits.find(chunkOrigin);
+    if (it == edits.end()) {
+        return;
+    }
+
+    Block* blocks = &chunk.blocks[0][0][0];
+    for (const auto& [index, type] : it->second) {
+        blocks[index].type = type;
+    }
+}
+
+bool EditJournal::hasEdits(glm::ivec3 chunkOrigin) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return edits.count(chunkOrigin) > 0;
+}
+
+void EditJournal::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file) {
+        return;
+    }
+
+    if (fileRecords > MIN_COMPACT_RECORDS && fileRecords > 2 * liveEdits) {
+        compact();
+    } else {
+        fflush(file);
+    }
+}
+
+bool EditJournal::compact() {
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+
+    // rewrite next to the old file and swap it in, so a crash leaves either the old or the new journal
+    std::string tempPath = path + ".tmp";
+    FILE* compacted = fopen(tempPath.c_str(), "wb");
+    if (!compacted) {
+        std::cerr << "Failed to open edit journal " << tempPath << " for writing, edits wont be saved" << std::endl;
+        return false;
+    }
+
+    JournalHeader header{JOURNAL_MAGIC, JOURNAL_VERSION, seed, World::GENERATOR_VERSION};
+    bool ok = fwrite(&header, sizeof(header), 1, compacted) == 1;
+
+    std::vector<JournalRecord> records;
+    for (const auto& [chunkOrigin, chunkEdits] : edits) {
+        records.clear();
+        for (const auto& [index, type] : chunkEdits) {
+            records.push_back(JournalRecord{chunkOrigin.x, chunkOrigin.y, chunkOrigin.z, index, type});
+        }
+        ok = ok && fwrite(records.data(), sizeof(JournalRecord), records.size(), compacted) == records.size();
+    }
+    ok = (fclose(compacted) == 0) && ok;
+
+    if (!ok || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to compact edit journal " << path << ", edits wont be saved" << std::endl;
+        return false;
+    }
+
+    fileRecords = liveEdits;
+    file = fopen(path.c_str(), "ab");
+    return file != nullptr;
+}
+
+size_t EditJournal::getEditCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return liveEdits;
+}
+
+size_t EditJournal::getFileRecordCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fileRecords;
+}
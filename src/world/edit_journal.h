@@ -0,0 +1,69 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <core/constants.h>
+#include <core/utils.h>
+#include <world/chunk.h>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <sys/types.h>
+
+
+// EDIT JOURNAL
+// terrain is deterministic from the seed, so only the blocks changed through World::setBlock are persisted
+// and replayed on top of every freshly generated (or loaded) chunk
+//
+// file: edits.<seed>-v<generator version>.journal in the save directory, a JournalHeader followed by JournalRecords
+// new edits are appended, the file is rewritten as one record per edited block (grouped per chunk)
+// once most of it is overwritten edits, and on every open
+// a journal whose header doesnt match is moved aside, never compacted over
+struct JournalHeader {
+    u_int32_t magic;
+    u_int32_t version;
+    int32_t   seed;
+    u_int32_t generatorVersion;     // World::GENERATOR_VERSION, edits only make sense on the terrain they were made on
+};
+
+#pragma pack(push, 1)
+struct JournalRecord {
+    int32_t  chunkX, chunkY, chunkZ;    // chunk origin
+    u_int16_t index;                    // local block, x*CHUNK_SIZE*CHUNK_SIZE + y*CHUNK_SIZE + z
+    u_int8_t  type;
+};
+#pragma pack(pop)
+static_assert(sizeof(JournalRecord) == 15, "JournalRecord is written to disk as is");
+
+class EditJournal {
+    public:
+        ~EditJournal();
+
+        bool open(const std::string& directory, int seed); // loads the existing edits and compacts the file
+        void close();
+
+        void record(glm::ivec3 blockPosition, glm::ivec3 chunkOrigin, u_int8_t type);
+        void apply(glm::ivec3 chunkOrigin, Chunk& chunk); // replays the edits of a chunk over its blocks
+        bool hasEdits(glm::ivec3 chunkOrigin);
+        void flush(); // pushes buffered records to disk, compacts when most of the file is dead records
+
+        size_t getEditCount();
+        size_t getFileRecordCount();
+
+    private:
+        static constexpr u_int32_t JOURNAL_MAGIC = 0x4E524A58; // "XJRN"
+        static constexpr u_int32_t JOURNAL_VERSION = 2;
+        static constexpr size_t MIN_COMPACT_RECORDS = 4096; // small journals are never worth rewriting
+
+        std::string path;
+        int seed = 0;
+        FILE* file = nullptr;
+        size_t fileRecords = 0; // records in the file, live or overwritten
+        size_t liveEdits = 0;
+
+        // compacted view, local block index -> type for every edited chunk
+        std::unordered_map<glm::ivec3, std::unordered_map<u_int16_t, u_int8_t>> edits;
+        std::mutex mutex;
+
+        bool compact(); // expects the mutex held
+};
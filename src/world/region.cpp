@@ -0,0 +1,336 @@
+#include <world/region.h>
+#include <world/world.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+std::string getRegionFileName(glm::ivec2 region) {
+    return "r." + std::to_string(region.x) + "." + std::to_string(region.y) + ".rgn";
+}
+
+bool moveFileAside(const std::string& path) {
+    for (int i = 0; i < 1000; i++) {
+        std::string backupPath = path + (i == 0 ? ".bak" : ".bak" + std::to_string(i));
+        std::error_code error;
+        if (std::filesystem::exists(backupPath, error) || error) {
+            continue;
+        }
+        if (std::rename(path.c_str(), backupPath.c_str()) != 0) {
+            std::cerr << "Failed to move " << path << " aside: " << strerror(errno) << std::endl;
+            return false;
+        }
+        std::cerr << "Moved " << path << " to " << backupPath << std::endl;
+        return true;
+    }
+    std::cerr << "No free backup name for " << path << std::endl;
+    return false;
+}
+
+void encodeChunkBlocks(const Chunk& chunk, std::vector<u_int8_t>& out) {
+    const Block* blocks = &chunk.blocks[0][0][0];
+    const int BLOCK_COUNT = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE; // fits the u16 run length
+
+    int i = 0;
+    while (i < BLOCK_COUNT) {
+        u_int8_t type = blocks[i].type;
+        int runEnd = i + 1;
+        while (runEnd < BLOCK_COUNT && blocks[runEnd].type == type) {
+            runEnd++;
+        }
+
+        u_int16_t count = static_cast<u_int16_t>(runEnd - i);
+        out.push_back(type);
+        out.push_back(count & 0xFF);
+        out.push_back(count >> 8);
+        i = runEnd;
+    }
+}
+
+bool decodeChunkBlocks(const u_int8_t* data, size_t size, Chunk& chunk) {
+    Block* blocks = &chunk.blocks[0][0][0];
+    const size_t BLOCK_COUNT = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+    size_t written = 0;
+    for (size_t i = 0; i + 3 <= size; i += 3) {
+        u_int8_t type = data[i];
+        size_t count = data[i+1] | (data[i+2] << 8);
+        if (count == 0 || written + count > BLOCK_COUNT) {
+            return false;
+        }
+        std::fill_n(blocks + written, count, Block{type});
+        written += count;
+    }
+    return size % 3 == 0 && written == BLOCK_COUNT;
+}
+
+RegionWriter::RegionWriter(glm::ivec2 region, int seed, int chunksPerColumn, bool withMeshes) {
+    header.magic = REGION_MAGIC;
+    header.formatVersion = REGION_FORMAT_VERSION;
+    header.seed = seed;
+    header.generatorVersion = World::GENERATOR_VERSION;
+    header.regionX = region.x;
+    header.regionZ = region.y;
+    header.chunksPerColumn = chunksPerColumn;
+    header.flags = withMeshes ? REGION_HAS_MESHES : 0;
+
+    slots.resize(REGION_COLUMNS * REGION_COLUMNS * chunksPerColumn);
+}
+
+void RegionWriter::setChunk(int localX, int chunkIndexY, int localZ, std::vector<u_int8_t> blocks, const std::vector<PackedFace>& faces) {
+    Slot& slot = slots[regionSlot(localX, chunkIndexY, localZ, header.chunksPerColumn)];
+    slot.stored = true;
+    slot.blockBytes = static_cast<u_int32_t>(blocks.size());
+    slot.faceCount = (header.flags & REGION_HAS_MESHES) ? static_cast<u_int32_t>(faces.size()) : 0;
+
+    slot.payload = std::move(blocks);
+    if (slot.faceCount) {
+        const u_int8_t* faceBytes = reinterpret_cast<const u_int8_t*>(faces.data());
+        slot.payload.insert(slot.payload.end(), faceBytes, faceBytes + faces.size() * sizeof(PackedFace));
+    }
+}
+
+bool RegionWriter::write(const std::string& path, size_t* bytesWritten) {
+    // lay out the offset table first, payloads follow it back to back
+    std::vector<RegionEntry> entries(slots.size());
+    size_t offset = sizeof(RegionHeader) + entries.size() * sizeof(RegionEntry);
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (!slots[i].stored) {
+            entries[i] = RegionEntry{0, 0, 0};
+            continue;
+        }
+        entries[i] = RegionEntry{static_cast<u_int32_t>(offset), slots[i].blockBytes, slots[i].faceCount};
+        offset += slots[i].payload.size();
+    }
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Failed to open region file " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && fwrite(entries.data(), sizeof(RegionEntry), entries.size(), file) == entries.size();
+    for (const Slot& slot : slots) {
+        if (ok && !slot.payload.empty()) {
+            ok = fwrite(slot.payload.data(), 1, slot.payload.size(), file) == slot.payload.size();
+        }
+    }
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok) {
+        std::cerr << "Failed to write region file " << path << std::endl;
+        return false;
+    }
+    if (bytesWritten) {
+        *bytesWritten = offset;
+    }
+    return true;
+}
+
+RegionStore::MappedRegion::~MappedRegion() {
+    if (data) {
+        munmap(const_cast<u_int8_t*>(data), size);
+    }
+}
+
+bool RegionStore::init(const std::string& directory, int seed, int chunksPerColumn, bool withMeshes) {
+    this->directory = directory;
+    this->seed = seed;
+    this->chunksPerColumn = chunksPerColumn;
+    this->withMeshes = withMeshes;
+    mappedRegions.clear();
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "Failed to create save directory " << directory << ": " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string RegionStore::getRegionPath(glm::ivec2 region) const {
+    return (std::filesystem::path(directory) / getRegionFileName(region)).string();
+}
+
+std::shared_ptr<const RegionStore::MappedRegion> RegionStore::mapRegion(glm::ivec2 region) {
+    auto mapped = std::make_shared<MappedRegion>();
+    std::string path = getRegionPath(region);
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (errno != ENOENT) {
+            std::cerr << "Failed to open region file " << path << ": " << strerror(errno) << std::endl;
+            mapped->status = MAP_STATUS::FAILED;
+        }
+        return mapped; // no file yet, nothing stored in this region
+    }
+
+    struct stat fileStat;
+    size_t tableEnd = sizeof(RegionHeader) + static_cast<size_t>(REGION_COLUMNS) * REGION_COLUMNS * chunksPerColumn * sizeof(RegionEntry);
+    MAP_STATUS failure = MAP_STATUS::FAILED;
+    if (fstat(fd, &fileStat) == 0) {
+        if (static_cast<size_t>(fileStat.st_size) < tableEnd) {
+            failure = MAP_STATUS::REJECTED; // truncated, or from a world with a different height
+        } else {
+            void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                madvise(data, fileStat.st_size, MADV_WILLNEED); // start reading the whole file in the background
+                mapped->data = static_cast<const u_int8_t*>(data);
+                mapped->size = fileStat.st_size;
+            }
+        }
+    }
+    close(fd); // the mapping stays valid without the descriptor
+
+    if (!mapped->data) {
+        std::cerr << "Failed to map region file " << path << std::endl;
+        auto unusable = std::make_shared<MappedRegion>();
+        unusable->status = failure;
+        return unusable;
+    }
+
+    // a file from another world or generator would put the wrong blocks in, so it is ignored as a whole
+    const RegionHeader& header = mapped->header();
+    if (header.magic != REGION_MAGIC || header.formatVersion != REGION_FORMAT_VERSION ||
+        header.chunksPerColumn != static_cast<u_int32_t>(chunksPerColumn) ||
+        header.seed != seed || header.generatorVersion != World::GENERATOR_VERSION ||
+        header.regionX != region.x || header.regionZ != region.y) {
+        std::cerr << "Ignoring region file " << path << " (seed " << header.seed << ", generator version " << header.generatorVersion
+                  << "), expected seed " << seed << ", generator version " << World::GENERATOR_VERSION << std::endl;
+        auto rejected = std::make_shared<MappedRegion>();
+        rejected->status = MAP_STATUS::REJECTED;
+        return rejected;
+    }
+    mapped->status = MAP_STATUS::MAPPED;
+    return mapped;
+}
+
+std::shared_ptr<const RegionStore::MappedRegion> RegionStore::getRegion(glm::ivec2 region) {
+    std::shared_ptr<const MappedRegion> mapped;
+    if (mappedRegions.get(region, mapped)) {
+        return mapped;
+    }
+
+    // two workers racing on the same region both map it, the cache keeps one and the other unmaps on release
+    mapped = mapRegion(region);
+    mappedRegions.put(region, mapped);
+    return mapped;
+}
+
+void RegionStore::MappedChunk::copyFaces(std::vector<PackedFace>& out) const {
+    out.resize(faceCount);
+    memcpy(out.data(), faces, faceCount * sizeof(PackedFace));
+}
+
+int RegionStore::getChunkSlot(glm::ivec3 chunkOrigin, glm::ivec2 region) const {
+    int localX = chunkIndexOf(chunkOrigin.x) - region.x * REGION_COLUMNS;
+    int localZ = chunkIndexOf(chunkOrigin.z) - region.y * REGION_COLUMNS;
+    int chunkIndexY = chunkIndexOf(chunkOrigin.y) + (chunksPerColumn - 1) / 2;
+    if (chunkIndexY < 0 || chunkIndexY >= chunksPerColumn) {
+        return -1;
+    }
+    return regionSlot(localX, chunkIndexY, localZ, chunksPerColumn);
+}
+
+bool RegionStore::readEntry(const MappedRegion& mapped, int slot, MappedChunk& chunk) const {
+    const RegionEntry& entry = mapped.entries()[slot];
+    size_t payloadEnd = static_cast<size_t>(entry.offset) + entry.blockBytes + static_cast<size_t>(entry.faceCount) * sizeof(PackedFace);
+    if (entry.offset == 0 || payloadEnd > mapped.size) {
+        return false;
+    }
+    chunk.blocks = mapped.data + entry.offset;
+    chunk.blockBytes = entry.blockBytes;
+    chunk.faces = chunk.blocks + entry.blockBytes;
+    chunk.faceCount = entry.faceCount;
+    return true;
+}
+
+bool RegionStore::hasChunk(glm::ivec3 chunkOrigin) {
+    glm::ivec2 region = getRegionCoord(chunkOrigin.x, chunkOrigin.z);
+    std::shared_ptr<const MappedRegion> mapped = getRegion(region);
+    int slot = getChunkSlot(chunkOrigin, region);
+
+    MappedChunk stored;
+    return mapped->data && slot >= 0 && readEntry(*mapped, slot, stored);
+}
+
+bool RegionStore::loadChunk(glm::ivec3 chunkOrigin, Chunk& chunk, std::vector<PackedFace>* faces) {
+    glm::ivec2 region = getRegionCoord(chunkOrigin.x, chunkOrigin.z);
+    std::shared_ptr<const MappedRegion> mapped = getRegion(region);
+    int slot = getChunkSlot(chunkOrigin, region);
+
+    MappedChunk stored;
+    if (!mapped->data || slot < 0 || !readEntry(*mapped, slot, stored)) {
+        return false;
+    }
+    if (!decodeChunkBlocks(stored.blocks, stored.blockBytes, chunk)) {
+        return false;
+    }
+    if (faces && (mapped->header().flags & REGION_HAS_MESHES)) {
+        stored.copyFaces(*faces);
+    }
+    return true;
+}
+
+bool RegionStore::saveChunks(glm::ivec2 region, const std::vector<StoredChunk>& chunks) {
+    std::lock_guard<std::mutex> lock(saveMutex);
+
+    // start from whatever the region already stores, then lay the new chunks over it
+    // (mapped straight from disk, a loader racing a previous save could have left a stale map in the cache)
+    RegionWriter writer(region, seed, chunksPerColumn, withMeshes);
+    std::shared_ptr<const MappedRegion> mapped = mapRegion(region);
+    std::string path = getRegionPath(region);
+    if (mapped->status == MAP_STATUS::FAILED) {
+        return false; // the file is there but couldnt be read, writing now would drop everything in it
+    }
+    if (mapped->status == MAP_STATUS::REJECTED && !moveFileAside(path)) {
+        return false; // belongs to another seed or generator, kept for whoever it belongs to
+    }
+    if (mapped->data) {
+        bool hadMeshes = mapped->header().flags & REGION_HAS_MESHES;
+        std::vector<PackedFace> faces;
+        for (int localX = 0; localX < REGION_COLUMNS; localX++) {
+            for (int localZ = 0; localZ < REGION_COLUMNS; localZ++) {
+                for (int y = 0; y < chunksPerColumn; y++) {
+                    MappedChunk stored;
+                    if (!readEntry(*mapped, regionSlot(localX, y, localZ, chunksPerColumn), stored)) {
+                        continue;
+                    }
+                    faces.clear();
+                    if (hadMeshes) {
+                        stored.copyFaces(faces);
+                    }
+                    writer.setChunk(localX, y, localZ, std::vector<u_int8_t>(stored.blocks, stored.blocks + stored.blockBytes), faces);
+                }
+            }
+        }
+    }
+
+    for (const StoredChunk& chunk : chunks) {
+        int localX = chunkIndexOf(chunk.chunkOrigin.x) - region.x * REGION_COLUMNS;
+        int localZ = chunkIndexOf(chunk.chunkOrigin.z) - region.y * REGION_COLUMNS;
+        int chunkIndexY = chunkIndexOf(chunk.chunkOrigin.y) + (chunksPerColumn - 1) / 2;
+        writer.setChunk(localX, chunkIndexY, localZ, chunk.blocks, chunk.faces);
+    }
+    // write next to the old file and swap it in, readers still holding the old map keep reading the old file
+    std::string tempPath = path + ".tmp";
+    if (!writer.write(tempPath)) {
+        return false;
+    }
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to replace region file " << path << std::endl;
+        return false;
+    }
+
+    mappedRegions.put(region, mapRegion(region));
+    return true;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <core/constants.h>
+#include <core/lru_cache.h>
+#include <core/utils.h>
+#include <world/chunk.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/types.h>
+
+
+// REGION FILE
+// REGION_COLUMNS x REGION_COLUMNS chunk columns (every vertical chunk of each column) in a single file
+//
+// layout, structs are written as is (little endian hosts only):
+//   RegionHeader
+//   RegionEntry[REGION_COLUMNS * REGION_COLUMNS * chunksPerColumn]    offset table, see regionSlot()
+//   payloads, in slot order
+//
+// a chunk payload is its blocks as RLE runs (type u8, count u16, in x,y,z memory order),
+// followed by its packed mesh faces when the region was written with meshes
+constexpr int REGION_COLUMNS = 32;
+constexpr u_int32_t REGION_MAGIC = 0x47524358; // "XCRG"
+constexpr u_int32_t REGION_FORMAT_VERSION = 1;
+constexpr u_int32_t REGION_HAS_MESHES = 1 << 0;
+
+struct RegionHeader {
+    u_int32_t magic;
+    u_int32_t formatVersion;
+    int32_t   seed;
+    u_int32_t generatorVersion;     // World::GENERATOR_VERSION, the file is stale once they differ
+    int32_t   regionX;
+    int32_t   regionZ;
+    u_int32_t chunksPerColumn;      // Y_LIMIT*2+1 of the world that wrote it
+    u_int32_t flags;
+};
+static_assert(sizeof(RegionHeader) == 32, "RegionHeader is written to disk as is");
+
+struct RegionEntry {
+    u_int32_t offset;       // from the start of the file, 0 = chunk not stored
+    u_int32_t blockBytes;   // RLE block payload size
+    u_int32_t faceCount;    // packed faces right after the block payload
+};
+static_assert(sizeof(RegionEntry) == 12, "RegionEntry is written to disk as is");
+
+// region coordinate of the chunk column at chunk origin x,z
+inline glm::ivec2 getRegionCoord(int chunkX, int chunkZ) {
+    return glm::ivec2(floorDiv(chunkX, REGION_COLUMNS * CHUNK_SIZE), floorDiv(chunkZ, REGION_COLUMNS * CHUNK_SIZE));
+}
+
+// localX/localZ are columns inside the region, chunkIndexY counts up from the bottom chunk of the world
+inline int regionSlot(int localX, int chunkIndexY, int localZ, int chunksPerColumn) {
+    return (localX * REGION_COLUMNS + localZ) * chunksPerColumn + chunkIndexY;
+}
+
+std::string getRegionFileName(glm::ivec2 region);
+
+// renames a save file that cant be used to the first free <path>.bak name, so writing a new one never destroys it
+bool moveFileAside(const std::string& path);
+
+// Block RLE, a fully solid or fully empty chunk is a single 3 byte run
+void encodeChunkBlocks(const Chunk& chunk, std::vector<u_int8_t>& out); // appends to out
+bool decodeChunkBlocks(const u_int8_t* data, size_t size, Chunk& chunk); // false on a malformed payload
+
+
+// REGION WRITER
+// collects chunk payloads in memory and writes them in slot order, so the file bytes never depend
+// on which thread finished first. setChunk is safe to call concurrently for different slots
+class RegionWriter {
+    public:
+        RegionWriter(glm::ivec2 region, int seed, int chunksPerColumn, bool withMeshes);
+
+        void setChunk(int localX, int chunkIndexY, int localZ, std::vector<u_int8_t> blocks, const std::vector<PackedFace>& faces);
+        bool write(const std::string& path, size_t* bytesWritten = nullptr);
+
+    private:
+        struct Slot {
+            bool stored = false;
+            u_int32_t blockBytes = 0;
+            u_int32_t faceCount = 0;
+            std::vector<u_int8_t> payload;
+        };
+
+        RegionHeader header;
+        std::vector<Slot> slots;
+};
+
+
+// STORED CHUNK
+// a chunk on its way into a RegionStore
+struct StoredChunk {
+    glm::ivec3 chunkOrigin;
+    std::vector<u_int8_t> blocks;   // RLE, see encodeChunkBlocks
+    std::vector<PackedFace> faces;  // only kept by stores with meshes
+};
+
+// REGION STORE
+// a directory of region files. Reads go through read only mmaps of whole files (prefetched, so a region streams in
+// on the first worker that touches it), a save rewrites its region into a temp file that is renamed over the old one,
+// so a crash never leaves half a region. A file from another seed or generator (or a truncated one) is moved aside
+// before a save replaces it, and a file that exists but couldnt be read fails the save instead of being overwritten
+// a store without meshes drops them when it rewrites a pregenerated region that had them
+class RegionStore {
+    public:
+        bool init(const std::string& directory, int seed, int chunksPerColumn, bool withMeshes = false);
+
+        bool hasChunk(glm::ivec3 chunkOrigin);
+        // false if the chunk isnt stored (or the file is bad), faces are filled when the file has meshes
+        bool loadChunk(glm::ivec3 chunkOrigin, Chunk& chunk, std::vector<PackedFace>* faces = nullptr);
+        // rewrites the whole region file, even for one edited block. The autosave does that every interval while the player
+        // keeps editing, fine at these file sizes but the next step would be appending changed chunks and fixing up the table in place
+        bool saveChunks(glm::ivec2 region, const std::vector<StoredChunk>& chunks);
+
+    private:
+        // a region file mapped into memory, data is nullptr when there is no usable file
+        enum class MAP_STATUS { MAPPED, NO_FILE, REJECTED, FAILED };
+        struct MappedRegion {
+            const u_int8_t* data = nullptr;
+            size_t size = 0;
+            MAP_STATUS status = MAP_STATUS::NO_FILE;
+            ~MappedRegion();
+
+            const RegionHeader& header() const { return *reinterpret_cast<const RegionHeader*>(data); }
+            const RegionEntry* entries() const { return reinterpret_cast<const RegionEntry*>(data + sizeof(RegionHeader)); }
+        };
+
+        // where one chunk sits inside a mapped region
+        struct MappedChunk {
+            const u_int8_t* blocks;
+            u_int32_t blockBytes;
+            const u_int8_t* faces;  // not aligned, RLE payloads are a multiple of 3 bytes
+            u_int32_t faceCount;
+
+            void copyFaces(std::vector<PackedFace>& out) const;
+        };
+
+        std::string directory;
+        int seed = 0;
+        int chunksPerColumn = 0;
+        bool withMeshes = false;
+
+        // only the regions around the player are live, evicted maps are unmapped once the last reader lets go
+        static constexpr size_t REGION_MAP_CACHE_SIZE = 64;
+        LruCache<glm::ivec2, std::shared_ptr<const MappedRegion>> mappedRegions{REGION_MAP_CACHE_SIZE};
+        std::mutex saveMutex; // one rewrite at a time
+
+        std::string getRegionPath(glm::ivec2 region) const;
+        std::shared_ptr<const MappedRegion> getRegion(glm::ivec2 region);
+        std::shared_ptr<const MappedRegion> mapRegion(glm::ivec2 region);
+        int getChunkSlot(glm::ivec3 chunkOrigin, glm::ivec2 region) const; // -1 outside the world's vertical range
+        bool readEntry(const MappedRegion& mapped, int slot, MappedChunk& chunk) const;
+};
@@ -1,6 +1,10 @@
 #include <world/world.h>
 #include <player/player.h>
 #include <iostream>
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cstring>
 
 // NOTE
 // when u call getBlock, if the region of the function call has not locked chunkMap, use a shared_lock to call this function
@@ -14,23 +18,26 @@ Block* World::getBlock(glm::ivec3 blockPosition) {
         return nullptr; // Chunk not found
     }
     
-    // Chunk exists, now get the block's local position
-    glm::ivec3 localPos = blockPosition - chunkCoord;
-    if (localPos.x < 0 || localPos.x >= CHUNK_SIZE ||
-        localPos.y < 0 || localPos.y >= CHUNK_SIZE ||
-        localPos.z < 0 || localPos.z >= CHUNK_SIZE){ 
-        return nullptr;
-    }
+    // Chunk exists, now get the block's local position (always inside the chunk)
+    glm::ivec3 localPos = localOf(blockPosition);
+    return &it->second->blocks[localPos.x][localPos.y][localPos.z];
+}
 
-    return &it->second.blocks[localPos.x][localPos.y][localPos.z];
+FlatMap<glm::ivec3, std::unique_ptr<Chunk>, ChunkCoordHash>::ProbeStats World::getChunkMapStats() {
+    std::shared_lock<std::shared_mutex> lock(chunkMapMutex);
+    return chunkMap.getProbeStats();
 }
 
-glm::ivec3 World::getChunkOrigin(glm::ivec3 blockPosition) {
-    return glm::ivec3(
-        floor(blockPosition.x / (float)CHUNK_SIZE) * CHUNK_SIZE,
-        floor(blockPosition.y / (float)CHUNK_SIZE) * CHUNK_SIZE,
-        floor(blockPosition.z / (float)CHUNK_SIZE) * CHUNK_SIZE
-    );
+const Chunk* World::getChunk(glm::ivec3 chunkOrigin) {
+    auto it = chunkMap.find(chunkOrigin);
+    return (it != chunkMap.end()) ? it->second.get() : nullptr;
+}
+
+void World::addGeneratedChunk(glm::ivec3 chunkOrigin, Chunk& chunk) {
+    chunk.state = CHUNK_STATE::GENERATED;
+    chunk.buildSolidMask();
+    std::unique_lock<std::shared_mutex> writeLock(chunkMapMutex);
+    chunkMap[chunkOrigin] = std::make_unique<Chunk>(std::move(chunk));
 }
 
 void World::setBlock(glm::ivec3 blockPosition, int type) {
@@ -41,122 +48,543 @@ void World::setBlock(glm::ivec3 blockPosition, int type) {
     // Find the chunk in the map. If it exists, modify it.
     auto it = chunkMap.find(chunkCoord);
     if (it != chunkMap.end()) {
-        glm::ivec3 localPos = blockPosition - chunkCoord;
-        it->second.blocks[localPos.x][localPos.y][localPos.z].type = type;
+        glm::ivec3 localPos = localOf(blockPosition);
+        it->second->blocks[localPos.x][localPos.y][localPos.z].type = type;
+        it->second->setSolid(localPos.x, localPos.y, localPos.z, type != 0);
+        it->second->edited = true;
+        if (journalEdits) {
+            editJournal.record(blockPosition, chunkCoord, type);
+        } else {
+            dirtyChunks.insert(chunkCoord);
+        }
     }
 }
 
-void World::generateChunks(glm::vec3 playerPosition) {
+void World::saveDirtyChunks() {
+    if (savePending.exchange(true)) {
+        return; // a save is already queued, it will pick up these edits too
+    }
+    // the chunk cache rewrites whole regions, so it waits until generation has settled down
+    bool writeChunkCache = threadpool->getWorkerQueueSize() == 0;
+    threadpool->enqueueBackWorkerTask([this, writeChunkCache]{
+        savePending = false;
+        flushDirtyChunks(writeChunkCache);
+    });
+}
 
-    glm::ivec3 playerChunkOrigin = getChunkOrigin(glm::round(playerPosition));
+void World::flushDirtyChunks(bool writeChunkCache) {
+    PROFILE_ZONE("Save chunks");
+    std::lock_guard<std::mutex> saveLock(saveMutex);
 
-    std::vector<glm::ivec3> chunksToGenerate;  // vector of all chunks around the player that we need to generate data for
-    chunksToGenerate.reserve((XZ_LOAD_DIST*2+1) * (XZ_LOAD_DIST*2+1) * (Y_LIMIT*2+1)); // Reserve space for worst case
+    editJournal.flush();
 
-    {   
-        std::shared_lock<std::shared_mutex> lock(chunkMapMutex); // put it outside the loop to avoid locking a shit ton of times which did cause lag in the main thread
+    // take the dirty set under a short exclusive lock, edits from here on land in a fresh set for the next save
+    std::unordered_set<glm::ivec3> savingChunks;
+    {
+        std::unique_lock<std::shared_mutex> writeLock(chunkMapMutex);
+        savingChunks.swap(dirtyChunks);
+    }
 
-        for (int cx = -XZ_LOAD_DIST; cx <= XZ_LOAD_DIST; cx++) {
-            for (int cz = -XZ_LOAD_DIST; cz <= XZ_LOAD_DIST; cz++) {
-    
-                // Use cylindrical distance
-                if (cx * cx + cz * cz > XZ_LOAD_DIST * XZ_LOAD_DIST) {
-                    continue;
-                }
-                
-                for (int y = -Y_LIMIT; y <= Y_LIMIT; y++) {
-                //decoupling Y to iterate from Y_LIMIT to -Y_LIMIT cause worlds vertical bounds is fixed and is independent of the players position
-                    
-                    glm::ivec3 chunkOrigin = glm::ivec3(
-                        playerChunkOrigin.x + (cx * CHUNK_SIZE),
-                        y * CHUNK_SIZE, 
-                        playerChunkOrigin.z + (cz * CHUNK_SIZE)
-                    );
-                    
-                    if(chunkOrigin.y < -(Y_LIMIT*CHUNK_SIZE) || chunkOrigin.y > Y_LIMIT*CHUNK_SIZE) {
-                        continue; // Skip chunks beyond vertical world limits
-                    }
-                    
-                    // If chunk data already exists, skip it
-                    if (chunkMap.count(chunkOrigin)) {
-                        continue;
-                    }
-    
-                    chunksToGenerate.push_back(chunkOrigin);                
+    // encoding only reads, raycasts and meshing keep going and only writers (setBlock, generation inserts) wait
+    std::unordered_map<glm::ivec2, std::vector<StoredChunk>> regionChunks;
+    {
+        std::shared_lock<std::shared_mutex> lock(chunkMapMutex);
+        for (const auto& chunkCoord : savingChunks) {
+            auto it = chunkMap.find(chunkCoord);
+            if (it == chunkMap.end()) {
+                continue;
+            }
+            std::vector<u_int8_t> encoded;
+            encodeChunkBlocks(*it->second, encoded);
+            regionChunks[getRegionCoord(chunkCoord.x, chunkCoord.z)].push_back(StoredChunk{chunkCoord, std::move(encoded), {}});
+        }
+    }
+
+    for (const auto& [region, chunks] : regionChunks) {
+        if (!regionStore.saveChunks(region, chunks)) {
+            // keep them dirty so the next save tries again
+            std::unique_lock<std::shared_mutex> writeLock(chunkMapMutex);
+            for (const auto& chunk : chunks) {
+                dirtyChunks.insert(chunk.chunkOrigin);
+            }
+        }
+    }
+
+    if (writeChunkCache) {
+        flushChunkCache();
+    }
+}
+
+void World::cacheChunk(glm::ivec3 chunkOrigin, const std::vector<PackedFace>& faces) {
+    // its only a cache, rewriting regions from the mesh workers while the world loads would cost far more than regenerating
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (pendingCacheChunkCount >= MAX_PENDING_CACHE_CHUNKS) {
+            return;
+        }
+    }
+
+    StoredChunk stored{chunkOrigin, {}, faces};
+    {
+        std::shared_lock<std::shared_mutex> lock(chunkMapMutex);
+        // an edit or unload since meshing means the blocks may no longer match the faces
+        auto it = chunkMap.find(chunkOrigin);
+        if (it == chunkMap.end() || it->second->edited) {
+            return;
+        }
+        encodeChunkBlocks(*it->second, stored.blocks);
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    pendingCacheChunks[getRegionCoord(chunkOrigin.x, chunkOrigin.z)].push_back(std::move(stored));
+    pendingCacheChunkCount++;
+}
+
+void World::flushChunkCache() {
+    std::unordered_map<glm::ivec2, std::vector<StoredChunk>> cacheChunks;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        cacheChunks.swap(pendingCacheChunks);
+        pendingCacheChunkCount = 0;
+    }
+    for (const auto& [region, chunks] : cacheChunks) {
+        chunkCache.saveChunks(region, chunks); // its only a cache, a failed write just means generating again next time
+    }
+}
+
+void World::buildLoadOrder() {
+    loadOrder.loadDist = XZ_LOAD_DIST;
+    loadOrder.yLimit = Y_LIMIT;
+    loadOrder.offsets.clear();
+
+    // y offsets span the whole world height from any chunk inside it
+    for (int cx = -XZ_LOAD_DIST; cx <= XZ_LOAD_DIST; cx++) {
+        for (int cz = -XZ_LOAD_DIST; cz <= XZ_LOAD_DIST; cz++) {
+            if (!isInLoadCylinder(cx, cz)) {
+                continue; // Use cylindrical distance
+            }
+            for (int y = -2 * Y_LIMIT; y <= 2 * Y_LIMIT; y++) {
+                loadOrder.offsets.push_back(glm::ivec3(cx, y, cz));
+            }
+        }
+    }
+
+    // squared distance, same order the per crossing sort used to produce
+    std::stable_sort(loadOrder.offsets.begin(), loadOrder.offsets.end(), [](const glm::ivec3& a, const glm::ivec3& b) {
+        return a.x*a.x + a.y*a.y + a.z*a.z < b.x*b.x + b.y*b.y + b.z*b.z;
+    });
+
+    // after a step of (dx, dz) a column is new if it wasnt in the cylinder around the previous chunk
+    for (int dx = -1; dx <= 1; dx++) {
+        for (int dz = -1; dz <= 1; dz++) {
+            std::vector<glm::ivec3>& step = loadOrder.steps[dx + 1][dz + 1];
+            step.clear();
+            for (const glm::ivec3& offset : loadOrder.offsets) {
+                if (!isInLoadCylinder(offset.x + dx, offset.z + dz)) {
+                    step.push_back(offset);
                 }
             }
         }
+    }
+}
+
+void World::prioritizeChunks(std::vector<glm::ivec3>& chunks, glm::ivec3 playerChunkOrigin, glm::vec3 playerVelocity, glm::vec3 viewDirection) {
+    glm::vec2 view(viewDirection.x, viewDirection.z);
+    bool hasView = glm::dot(view, view) > 1e-6f;
+    if (hasView) {
+        view = glm::normalize(view);
+    }
+    // in chunks from the player chunk, where the player will be in PREFETCH_SECONDS
+    glm::vec2 predicted = glm::vec2(playerVelocity.x, playerVelocity.z) * (PREFETCH_SECONDS / CHUNK_SIZE);
+    bool hasPrediction = glm::dot(predicted, predicted) > 1.0f; // less than a chunk ahead isnt worth reordering for
+
+    if (!hasView && !hasPrediction) {
+        return; // stays in radial order
+    }
+
+    // distance in chunks, to the player or the predicted position whichever is closer, shrunk inside the view cone
+    std::vector<std::pair<float, glm::ivec3>> keyed;
+    keyed.reserve(chunks.size());
+    for (const glm::ivec3& chunkOrigin : chunks) {
+        glm::vec3 offset = glm::vec3(chunkOrigin - playerChunkOrigin) / static_cast<float>(CHUNK_SIZE);
+        glm::vec2 offsetXZ(offset.x, offset.z);
+
+        float distance = glm::length(offset);
+        if (hasPrediction) {
+            glm::vec2 fromPredicted = offsetXZ - predicted;
+            distance = std::min(distance, std::sqrt(glm::dot(fromPredicted, fromPredicted) + offset.y * offset.y));
+        }
+        float lengthXZ = glm::length(offsetXZ);
+        if (hasView && lengthXZ > 0.0f && glm::dot(offsetXZ / lengthXZ, view) > VIEW_CONE_COS) {
+            distance *= VIEW_CONE_BIAS;
+        }
+        keyed.emplace_back(distance, chunkOrigin);
+    }
 
+    std::stable_sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (size_t i = 0; i < chunks.size(); i++) {
+        chunks[i] = keyed[i].second;
     }
+}
 
+bool World::isStillWanted(glm::ivec3 chunkOrigin) {
+    std::lock_guard<std::mutex> orderLock(loadOrderMutex);
+    if (!hasLoadOrigin) {
+        return true; // generated directly, not through generateChunks
+    }
+    // if the player comes back the column is exposed again by a ring and requeued
+    glm::ivec3 chunk = chunkIndexOf(chunkOrigin);
+    return isInLoadCylinder(chunk.x - lastLoadOrigin.x, chunk.z - lastLoadOrigin.z);
+}
 
-    std::sort(chunksToGenerate.begin(), chunksToGenerate.end(), [playerChunkOrigin](const glm::ivec3& a, const glm::ivec3& b) {
-        // Calculate squared distance (cheaper than using sqrt)
-        int distA = (a.x - playerChunkOrigin.x)*(a.x - playerChunkOrigin.x) + 
-                    (a.y - playerChunkOrigin.y)*(a.y - playerChunkOrigin.y) + 
-                    (a.z - playerChunkOrigin.z)*(a.z - playerChunkOrigin.z);
-                    
-        int distB = (b.x - playerChunkOrigin.x)*(b.x - playerChunkOrigin.x) + 
-                    (b.y - playerChunkOrigin.y)*(b.y - playerChunkOrigin.y) + 
-                    (b.z - playerChunkOrigin.z)*(b.z - playerChunkOrigin.z);
-                    
-        return distA < distB; // Sort ascending
-    });    
+void World::requestChunks(glm::vec3 playerPosition, glm::vec3 playerVelocity, glm::vec3 viewDirection) {
+    u_int64_t loadSequence = ++requestedLoadSequence;
+    threadpool->enqueueBackWorkerTask([this, playerPosition, playerVelocity, viewDirection, loadSequence]{
+        generateChunks(playerPosition, playerVelocity, viewDirection, loadSequence);
+    });
+}
+
+void World::generateChunks(glm::vec3 playerPosition, glm::vec3 playerVelocity, glm::vec3 viewDirection, u_int64_t loadSequence) {
+    PROFILE_ZONE("generateChunks");
+
+    glm::ivec3 playerChunkOrigin = getChunkOrigin(glm::round(playerPosition));
+    glm::ivec3 playerChunk = chunkIndexOf(playerChunkOrigin);
+    // y offsets only reach 2*Y_LIMIT, so order from the nearest chunk inside the world when flying above or below it
+    int playerChunkY = std::clamp(playerChunk.y, -Y_LIMIT, Y_LIMIT);
 
-    if (!chunksToGenerate.empty()) {
-        for (const auto& chunkOrigin : chunksToGenerate) {
-            threadpool->enqueueBackWorkerTask([this, chunkOrigin]{
-                generateChunkData(chunkOrigin);
-            });
+    std::vector<glm::ivec3> chunksToGenerate;  // chunks around the player that we need to generate data for, nearest first
+
+    {
+        std::lock_guard<std::mutex> orderLock(loadOrderMutex);
+        // a newer request already queued everything around a newer origin
+        if (loadSequence != 0) {
+            if (loadSequence < appliedLoadSequence) {
+                return;
+            }
+            appliedLoadSequence = loadSequence;
         }
-    }    
+        if (loadOrder.loadDist != XZ_LOAD_DIST || loadOrder.yLimit != Y_LIMIT) {
+            buildLoadOrder();
+            hasLoadOrigin = false;
+        }
+
+        // a one chunk step only needs the newly exposed ring, anything else walks the whole table
+        glm::ivec3 step = hasLoadOrigin ? playerChunk - lastLoadOrigin : glm::ivec3(INT_MAX);
+        bool ringOnly = std::abs(step.x) <= 1 && std::abs(step.z) <= 1;
+        const std::vector<glm::ivec3>& offsets = ringOnly ? loadOrder.steps[step.x + 1][step.z + 1] : loadOrder.offsets;
+
+        std::shared_lock<std::shared_mutex> lock(chunkMapMutex); // put it outside the loop to avoid locking a shit ton of times which did cause lag in the main thread
+
+        for (const glm::ivec3& offset : offsets) {
+            int chunkY = playerChunkY + offset.y;
+            if (chunkY < -Y_LIMIT || chunkY > Y_LIMIT) {
+                continue; // Skip chunks beyond vertical world limits
+            }
+
+            // columns around the last origin were already queued by the previous call
+            if (hasLoadOrigin && !ringOnly && isInLoadCylinder(playerChunk.x + offset.x - lastLoadOrigin.x, playerChunk.z + offset.z - lastLoadOrigin.z)) {
+                continue;
+            }
+
+            glm::ivec3 chunkOrigin = glm::ivec3(
+                playerChunkOrigin.x + (offset.x * CHUNK_SIZE),
+                chunkY * CHUNK_SIZE, 
+                playerChunkOrigin.z + (offset.z * CHUNK_SIZE)
+            );
+
+            // If chunk data already exists, skip it
+            if (chunkMap.count(chunkOrigin)) {
+                continue;
+            }
+
+            chunksToGenerate.push_back(chunkOrigin);                
+        }
+
+        lastLoadOrigin = playerChunk;
+        hasLoadOrigin = true;
+    }
+
+    prioritizeChunks(chunksToGenerate, playerChunkOrigin, playerVelocity, viewDirection);
+
+    for (const auto& chunkOrigin : chunksToGenerate) {
+        threadpool->enqueueBackWorkerTask([this, chunkOrigin]{
+            generateChunkData(chunkOrigin);
+        });
+    }
 }
 
-void World::generateChunkData(glm::ivec3 chunkOrigin) {
-    Chunk currentChunk;
+std::shared_ptr<const ColumnHeightmap> World::calculateColumnHeightmap(int chunkX, int chunkZ) {
+    auto heightmap = std::make_shared<ColumnHeightmap>();
+    heightmap->minHeight = INT_MAX;
+    heightmap->maxHeight = INT_MIN;
+
+    BiomeSample biomeSamples[CHUNK_SIZE][CHUNK_SIZE];
+    biomeMap.sampleColumn(chunkX, chunkZ, biomeSamples);
 
-    // precompute the height values for each x,z column in the chunk to save some redundant noise calculations in the inner loop
-    float localHeights[CHUNK_SIZE][CHUNK_SIZE]; 
     for (int x = 0; x < CHUNK_SIZE; x++) {
         for (int z = 0; z < CHUNK_SIZE; z++) {
-            float globalX = (float)(chunkOrigin.x + x);
-            float globalZ = (float)(chunkOrigin.z + z);
+            const BiomeSample& biome = biomeSamples[x][z];
+            float globalX = (float)(chunkX + x);
+            float globalZ = (float)(chunkZ + z);
 
             warpNoise.DomainWarp(globalX, globalZ);
             float noiseVal = baseNoise.GetNoise(globalX, globalZ);
-            localHeights[x][z] = 64 + static_cast<int>(noiseVal * 30.0f);
+            int height = static_cast<int>(biome.baseHeight) + static_cast<int>(noiseVal * biome.heightScale);
+            heightmap->heights[x][z] = height;
+            heightmap->biomes[x][z] = biome.biome;
+            heightmap->minHeight = std::min(heightmap->minHeight, height);
+            heightmap->maxHeight = std::max(heightmap->maxHeight, height);
         }
-    }    
-    
+    }
+    return heightmap;
+}
 
-    // maintain x y z order in the loops to make sure the memory access pattern is cache friendly
+std::shared_ptr<const ColumnHeightmap> World::getColumnHeightmap(int chunkX, int chunkZ) {
+    glm::ivec2 columnKey(chunkX, chunkZ);
+
+    std::shared_ptr<const ColumnHeightmap> heightmap;
+    if (heightmapCache.get(columnKey, heightmap)) {
+        return heightmap;
+    }
+
+    // computed outside the cache lock, two workers racing on the same column just do the work twice
+    heightmap = calculateColumnHeightmap(chunkX, chunkZ);
+    heightmapCache.put(columnKey, heightmap);
+    return heightmap;
+}
+
+int World::getTerrainHeight(int x, int z) {
+    glm::ivec3 chunkOrigin = getChunkOrigin(glm::ivec3(x, 0, z));
+    std::shared_ptr<const ColumnHeightmap> heightmap = getColumnHeightmap(chunkOrigin.x, chunkOrigin.z);
+    return heightmap->heights[x - chunkOrigin.x][z - chunkOrigin.z];
+}
+
+BIOME World::getBiome(int x, int z) {
+    glm::ivec3 chunkOrigin = getChunkOrigin(glm::ivec3(x, 0, z));
+    std::shared_ptr<const ColumnHeightmap> heightmap = getColumnHeightmap(chunkOrigin.x, chunkOrigin.z);
+    return heightmap->biomes[x - chunkOrigin.x][z - chunkOrigin.z];
+}
+
+ColumnSpans World::calculateColumnSpans(int chunkY, int height, BIOME biome) {
+    // clamp every layer boundary into the chunk's local y range, empty runs end up with begin == end
+    auto toLocal = [chunkY](int globalY) {
+        return std::clamp(globalY - chunkY, 0, CHUNK_SIZE);
+    };
+
+    ColumnSpans spans;
+    spans.stoneBegin = toLocal(-(Y_LIMIT*CHUNK_SIZE)); // nothing below the vertical world limit
+    spans.stoneEnd      = std::max(toLocal(height - 5), spans.stoneBegin);    // stone up to height-6
+    spans.subsurfaceEnd = std::max(toLocal(height), spans.stoneEnd);          // 5 blocks of subsurface
+    spans.surfaceEnd    = std::max(toLocal(height + 1), spans.subsurfaceEnd); // surface block at height
+
+    const BiomeParams& params = biomeParams[static_cast<int>(biome)];
+    spans.subsurfaceBlock = params.subsurfaceBlock;
+    spans.surfaceBlock = params.surfaceBlock;
+    if (biome == BIOME::MOUNTAINS && height >= 110) {
+        spans.surfaceBlock = 5; // Snow caps on the peaks
+    }
+    return spans;
+}
+
+void World::generateChunkBlocks(glm::ivec3 chunkOrigin, Chunk& chunk) {
+    PROFILE_ZONE("Generate blocks");
+    // every vertical chunk of a column shares the same heights, so they come from the column cache
+    std::shared_ptr<const ColumnHeightmap> heightmap = getColumnHeightmap(chunkOrigin.x, chunkOrigin.z);
+    fillChunkBlocks(chunkOrigin, *heightmap, chunk);
+    carveCaves(chunkOrigin, *heightmap, chunk);
+}
+
+void World::fillChunkBlocks(glm::ivec3 chunkOrigin, const ColumnHeightmap& heightmap, Chunk& chunk) {
+
+    // whole chunk above the highest surface, blocks are already air
+    if (chunkOrigin.y > heightmap.maxHeight) {
+        return;
+    }
+
+    // whole chunk inside the stone layer of every column
+    if (chunkOrigin.y + CHUNK_SIZE - 1 <= heightmap.minHeight - 6 && chunkOrigin.y >= -(Y_LIMIT*CHUNK_SIZE)) {
+        memset(chunk.blocks, 3, sizeof(chunk.blocks)); // Block is a single byte, so this writes type 3 (Stone) everywhere
+        return;
+    }
+
+    // mixed chunk, every column is written as runs of layers instead of comparing heights per block
     for (int x = 0; x < CHUNK_SIZE; x++) {
-        for (int y = 0; y < CHUNK_SIZE; y++) {
-            int globalY = chunkOrigin.y + y;
-            for (int z = 0; z < CHUNK_SIZE; z++) {
-
-                int height = localHeights[x][z]; // use precomputed height value
-
-                if (globalY > height) {
-                    currentChunk.blocks[x][y][z].type = 0; // Air
-                } else if (globalY == (int)height) {
-                    currentChunk.blocks[x][y][z].type = 1; // Grass
-                } else if (globalY >= height - 5) {
-                    currentChunk.blocks[x][y][z].type = 2; // Dirt
-                } else if (globalY >= -(Y_LIMIT*CHUNK_SIZE)) {
-                    currentChunk.blocks[x][y][z].type = 3; // Stone
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            ColumnSpans spans = calculateColumnSpans(chunkOrigin.y, heightmap.heights[x][z], heightmap.biomes[x][z]);
+
+            for (int y = spans.stoneBegin;    y < spans.stoneEnd;      y++) chunk.blocks[x][y][z].type = 3; // Stone
+            for (int y = spans.stoneEnd;      y < spans.subsurfaceEnd; y++) chunk.blocks[x][y][z].type = spans.subsurfaceBlock;
+            for (int y = spans.subsurfaceEnd; y < spans.surfaceEnd;    y++) chunk.blocks[x][y][z].type = spans.surfaceBlock;
+            // everything above surfaceEnd stays air
+        }
+    }
+}
+
+void World::carveCaves(glm::ivec3 chunkOrigin, const ColumnHeightmap& heightmap, Chunk& chunk) {
+    PROFILE_ZONE("Carve caves");
+
+    int caveFloor = -(Y_LIMIT*CHUNK_SIZE) + CAVE_FLOOR_DEPTH;
+
+    // whole chunk is air or below the cave floor, nothing to carve
+    if (chunkOrigin.y > heightmap.maxHeight || chunkOrigin.y + CHUNK_SIZE - 1 < caveFloor) {
+        return;
+    }
+
+    // only lattice layers between the cave floor and the highest surface can ever be carved
+    int lowestY = std::max(chunkOrigin.y, caveFloor);
+    int highestY = std::min(chunkOrigin.y + CHUNK_SIZE - 1, heightmap.maxHeight);
+    int firstLayer = (lowestY - chunkOrigin.y) / CAVE_LATTICE_Y;
+    int lastLayer = (highestY - chunkOrigin.y) / CAVE_LATTICE_Y;
+
+    // the highest surface over each lattice cell column, so cells sitting above the terrain get skipped
+    int cellMaxHeight[CAVE_NODES_XZ-1][CAVE_NODES_XZ-1];
+    for (int cx = 0; cx < CAVE_NODES_XZ-1; cx++) {
+        for (int cz = 0; cz < CAVE_NODES_XZ-1; cz++) {
+            int maxHeight = INT_MIN;
+            for (int x = cx*CAVE_LATTICE_XZ; x < (cx+1)*CAVE_LATTICE_XZ; x++) {
+                for (int z = cz*CAVE_LATTICE_XZ; z < (cz+1)*CAVE_LATTICE_XZ; z++) {
+                    maxHeight = std::max(maxHeight, heightmap.heights[x][z]);
+                }
+            }
+            cellMaxHeight[cx][cz] = maxHeight;
+        }
+    }
+
+    // density at the lattice nodes of the active layers only
+    float density[CAVE_NODES_XZ][CAVE_NODES_Y][CAVE_NODES_XZ];
+    for (int nx = 0; nx < CAVE_NODES_XZ; nx++) {
+        for (int ny = firstLayer; ny <= lastLayer + 1; ny++) {
+            for (int nz = 0; nz < CAVE_NODES_XZ; nz++) {
+                density[nx][ny][nz] = caveNoise.GetNoise(
+                    (float)(chunkOrigin.x + nx*CAVE_LATTICE_XZ),
+                    (float)(chunkOrigin.y + ny*CAVE_LATTICE_Y),
+                    (float)(chunkOrigin.z + nz*CAVE_LATTICE_XZ)
+                );
+            }
+        }
+    }
+
+    for (int cx = 0; cx < CAVE_NODES_XZ-1; cx++) {
+        for (int cy = firstLayer; cy <= lastLayer; cy++) {
+            for (int cz = 0; cz < CAVE_NODES_XZ-1; cz++) {
+
+                if (chunkOrigin.y + cy*CAVE_LATTICE_Y > cellMaxHeight[cx][cz]) {
+                    continue; // cell is above the terrain
+                }
+
+                float d000 = density[cx][cy][cz],     d100 = density[cx+1][cy][cz];
+                float d010 = density[cx][cy+1][cz],   d110 = density[cx+1][cy+1][cz];
+                float d001 = density[cx][cy][cz+1],   d101 = density[cx+1][cy][cz+1];
+                float d011 = density[cx][cy+1][cz+1], d111 = density[cx+1][cy+1][cz+1];
+
+                // trilinear interpolation never exceeds the largest corner, so most cells are proven solid here
+                float maxDensity = std::max({d000, d100, d010, d110, d001, d101, d011, d111});
+                if (maxDensity <= CAVE_THRESHOLD) {
+                    continue;
+                }
+
+                // same bound again per x plane and per z row, interpolation stays inside its end points
+                for (int lx = 0; lx < CAVE_LATTICE_XZ; lx++) {
+                    float fx = (float)lx / CAVE_LATTICE_XZ;
+                    float d00 = d000 + (d100 - d000) * fx;
+                    float d10 = d010 + (d110 - d010) * fx;
+                    float d01 = d001 + (d101 - d001) * fx;
+                    float d11 = d011 + (d111 - d011) * fx;
+                    if (std::max({d00, d10, d01, d11}) <= CAVE_THRESHOLD) {
+                        continue;
+                    }
+
+                    for (int ly = 0; ly < CAVE_LATTICE_Y; ly++) {
+                        float fy = (float)ly / CAVE_LATTICE_Y;
+                        float d0 = d00 + (d10 - d00) * fy;
+                        float d1 = d01 + (d11 - d01) * fy;
+
+                        int y = cy*CAVE_LATTICE_Y + ly;
+                        if (std::max(d0, d1) <= CAVE_THRESHOLD || chunkOrigin.y + y < caveFloor) {
+                            continue;
+                        }
+
+                        // z is the contiguous axis, so this row is a straight branch free run
+                        // (0xFF keeps the block, 0x00 turns it into air)
+                        u_int8_t* row = &chunk.blocks[cx*CAVE_LATTICE_XZ + lx][y][cz*CAVE_LATTICE_XZ].type;
+                        float step = (d1 - d0) / CAVE_LATTICE_XZ;
+                        for (int lz = 0; lz < CAVE_LATTICE_XZ; lz++) {
+                            row[lz] &= static_cast<u_int8_t>(-static_cast<int>(d0 + step * lz <= CAVE_THRESHOLD));
+                        }
+                    }
                 }
             }
         }
     }
+}
+
+bool World::canUseCachedMesh(glm::ivec3 chunkOrigin) {
+    // a cached mesh was built against the generator output of the chunk and its neighbours
+    if (editJournal.hasEdits(chunkOrigin)) {
+        return false;
+    }
+    for (auto neighbourOffset : neighbourChunks) {
+        glm::ivec3 neighbourCoord = chunkOrigin + neighbourOffset;
+        if (editJournal.hasEdits(neighbourCoord) || regionStore.hasChunk(neighbourCoord)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void World::generateChunkData(glm::ivec3 chunkOrigin) {
+    PROFILE_ZONE("generateChunkData");
+    {
+        // a column can be queued twice (revisited ring edges, jumps), the first one wins
+        std::shared_lock<std::shared_mutex> lock(chunkMapMutex);
+        if (chunkMap.count(chunkOrigin)) {
+            return;
+        }
+    }
+    if (!isStillWanted(chunkOrigin)) {
+        return; // queued a while ago and the player has flown past, dont hold up the chunks ahead
+    }
+
+    Chunk currentChunk;
+    std::vector<PackedFace> cachedFaces;
+    bool useCachedMesh = false;
+
+    // region files (edits, pregenerated areas) first, then the chunk cache, then the generator
+    if (regionStore.loadChunk(chunkOrigin, currentChunk)) {
+        currentChunk.edited = true;
+        storedChunkCount++;
+    } else if (useChunkCache && chunkCache.loadChunk(chunkOrigin, currentChunk, &cachedFaces)) {
+        currentChunk.cached = true;
+        useCachedMesh = canUseCachedMesh(chunkOrigin);
+        cachedChunkCount++;
+    } else {
+        generateChunkBlocks(chunkOrigin, currentChunk); // not stored, generate it from noise
+        generatedChunkCount++;
+    }
+
+    if (editJournal.hasEdits(chunkOrigin)) {
+        editJournal.apply(chunkOrigin, currentChunk);
+        currentChunk.edited = true;
+    }
 
-    currentChunk.state = CHUNK_STATE::GENERATED; // mark chunk as generated
+    // a usable cached mesh skips meshing entirely, neighbours see the chunk as already meshed
+    currentChunk.state = useCachedMesh ? CHUNK_STATE::MESHED : CHUNK_STATE::GENERATED;
+    currentChunk.meshBuilt = useCachedMesh;
+    currentChunk.meshVersion = useCachedMesh ? 1 : 0;
+    currentChunk.buildSolidMask();
 
     {
         std::unique_lock<std::shared_mutex> writeLock(chunkMapMutex);
-        chunkMap[chunkOrigin] = std::move(currentChunk);
+        chunkMap[chunkOrigin] = std::make_unique<Chunk>(std::move(currentChunk));
     }    
 
+    if (useCachedMesh) {
+        ChunkMesh mesh;
+        mesh.version = 1;
+        expandChunkFaces(cachedFaces, chunkOrigin, mesh);
+        queueChunkUpload(chunkOrigin, mesh, true);
+    }
+
     // try to calculate the mesh for current chunk(mostly fails cause the neighbours ususally arent generated yet)
     tryCalculateChunkMesh(chunkOrigin);   
     
@@ -167,13 +595,14 @@ void World::generateChunkData(glm::ivec3 chunkOrigin) {
 }
 
 void World::tryCalculateChunkMesh(glm::ivec3 chunkCoord) {
+    PROFILE_ZONE("tryCalculateChunkMesh");
 
     bool canMesh = false;
     {
         std::shared_lock<std::shared_mutex> lock(chunkMapMutex);
 
         auto it = chunkMap.find(chunkCoord);
-        if (it != chunkMap.end() && it->second.state == CHUNK_STATE::GENERATED) {            
+        if (it != chunkMap.end() && it->second->state == CHUNK_STATE::GENERATED) {            
             canMesh = true;
 
             for(auto neighbourOffset : neighbourChunks) {
@@ -184,7 +613,7 @@ void World::tryCalculateChunkMesh(glm::ivec3 chunkCoord) {
                 }
                 
                 it = chunkMap.find(neighbourCoord);
-                if (it == chunkMap.end() || it->second.state == CHUNK_STATE::EMPTY) {
+                if (it == chunkMap.end() || it->second->state == CHUNK_STATE::EMPTY) {
                     canMesh = false; // if any neighbour is not generated, we cannot mesh this chunk yet
                     break;
                 }
@@ -196,11 +625,12 @@ void World::tryCalculateChunkMesh(glm::ivec3 chunkCoord) {
     if (canMesh) {
         std::unique_lock<std::shared_mutex> writeLock(chunkMapMutex);
 
-        if (chunkMap[chunkCoord].state != CHUNK_STATE::GENERATED) {
+        auto it = chunkMap.find(chunkCoord);
+        if (it == chunkMap.end() || it->second->state != CHUNK_STATE::GENERATED) {
             return; // another thread couldve meshed while we unlocked
         }
             
-        chunkMap[chunkCoord].state = CHUNK_STATE::MESHED; 
+        it->second->state = CHUNK_STATE::MESHED; 
 
         threadpool->enqueueFrontWorkerTask([this, chunkCoord]{
             calculateChunkMesh(chunkCoord);
@@ -209,46 +639,70 @@ void World::tryCalculateChunkMesh(glm::ivec3 chunkCoord) {
 
 }
 
-void World::updateChunkAndNeighboursMesh(glm::ivec3 block) {
+void World::updateChunkAndNeighboursMesh(glm::ivec3 block, std::chrono::steady_clock::time_point editTime) {
     glm::ivec3 chunkCoord = getChunkOrigin(block);
-    glm::ivec3 blockOffset = block - chunkCoord;
+    glm::ivec3 blockOffset = localOf(block);
+
+    // the edited block and the faces its neighbours show towards it are all in its own section,
+    // unless its at the edge of a section where the block below or above has a face in the next one
+    int section = blockOffset.y >> SECTION_SHIFT;
+    int sectionBegin = section;
+    int sectionEnd = section + 1;
+    if ((blockOffset.y & (SECTION_HEIGHT - 1)) == 0 && section > 0) {
+        sectionBegin--;
+    } else if ((blockOffset.y & (SECTION_HEIGHT - 1)) == SECTION_HEIGHT - 1 && section < CHUNK_SECTIONS - 1) {
+        sectionEnd++;
+    }
 
-    std::vector<glm::ivec3> chunksToRemesh;
+    struct Remesh {
+        glm::ivec3 chunkCoord;
+        int sectionBegin;
+        int sectionEnd;
+    };
+    std::vector<Remesh> chunksToRemesh;
     chunksToRemesh.reserve(4); 
 
     // Always recalculate the mesh for the chunk the block is in
-    chunksToRemesh.push_back(chunkCoord);
+    chunksToRemesh.push_back({chunkCoord, sectionBegin, sectionEnd});
 
-    // If the block is on a boundary, the neighbor chunk's mesh is also affected
+    // If the block is on a boundary, the neighbor chunk's mesh is also affected (just the face touching the block)
     if (blockOffset.x == 0) {
-        chunksToRemesh.push_back(chunkCoord + glm::ivec3(-CHUNK_SIZE, 0, 0));
+        chunksToRemesh.push_back({chunkCoord + glm::ivec3(-CHUNK_SIZE, 0, 0), section, section + 1});
     } else if (blockOffset.x == CHUNK_SIZE - 1) {
-        chunksToRemesh.push_back(chunkCoord + glm::ivec3(CHUNK_SIZE, 0, 0));
+        chunksToRemesh.push_back({chunkCoord + glm::ivec3(CHUNK_SIZE, 0, 0), section, section + 1});
     }
     
     if (blockOffset.y == 0) {
-        chunksToRemesh.push_back(chunkCoord + glm::ivec3(0, -CHUNK_SIZE, 0));
+        chunksToRemesh.push_back({chunkCoord + glm::ivec3(0, -CHUNK_SIZE, 0), CHUNK_SECTIONS - 1, CHUNK_SECTIONS});
     } else if (blockOffset.y == CHUNK_SIZE - 1) {
-        chunksToRemesh.push_back(chunkCoord + glm::ivec3(0, CHUNK_SIZE, 0));
+        chunksToRemesh.push_back({chunkCoord + glm::ivec3(0, CHUNK_SIZE, 0), 0, 1});
     }
 
     if (blockOffset.z == 0) {
-        chunksToRemesh.push_back(chunkCoord + glm::ivec3(0, 0, -CHUNK_SIZE));
+        chunksToRemesh.push_back({chunkCoord + glm::ivec3(0, 0, -CHUNK_SIZE), section, section + 1});
     } else if (blockOffset.z == CHUNK_SIZE - 1) {
-        chunksToRemesh.push_back(chunkCoord + glm::ivec3(0, 0, CHUNK_SIZE));
+        chunksToRemesh.push_back({chunkCoord + glm::ivec3(0, 0, CHUNK_SIZE), section, section + 1});
     }
 
-    for (const auto& coord : chunksToRemesh) {
-        threadpool->enqueueFrontWorkerTask([this, coord]{
-            calculateChunkMesh(coord);
+    auto edit = std::make_shared<PendingEdit>();
+    edit->start = editTime;
+    edit->startFrame = frameCounter;
+    edit->remainingChunks = static_cast<int>(chunksToRemesh.size());
+
+    for (const auto& remesh : chunksToRemesh) {
+        threadpool->enqueueFrontWorkerTask([this, remesh, edit]{
+            calculateChunkMesh(remesh.chunkCoord, remesh.sectionBegin, remesh.sectionEnd, edit);
         });
     }
 }
 
-void World::populateChunkBitMask(Chunk& chunk, glm::ivec3 chunkCoord, u_int64_t x_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t y_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t z_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2]){
+void World::populateChunkBitMask(const Chunk& chunk, int yBegin, int yEnd, u_int64_t x_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t y_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t z_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2]){
     // create bitmask representation of chunk, where 1 represents a solid block, 0 represents air
+    // one block above and below the wanted range too, the y faces there depend on it
+    int maskBegin = std::max(yBegin - 1, 0);
+    int maskEnd = std::min(yEnd + 1, CHUNK_SIZE);
     for(int x=0; x<CHUNK_SIZE; x++){
-        for(int y=0; y<CHUNK_SIZE; y++){
+        for(int y=maskBegin; y<maskEnd; y++){
             for(int z=0; z<CHUNK_SIZE; z++){
                 if (chunk.blocks[x][y][z].type != 0) {
                     x_solid_mask[y+1][z+1] |= (1ULL << (x+1)); // +1 for padding offset(this is what we subtract when calculating actual blockPos in mesh generation)
@@ -260,74 +714,69 @@ void World::populateChunkBitMask(Chunk& chunk, glm::ivec3 chunkCoord, u_int64_t
     }
 }
 
-void World::populateChunkBitMaskPadding(Chunk& chunk, glm::ivec3 chunkCoord, u_int64_t x_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t y_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t z_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2]){
+void World::populateChunkBitMaskPadding(const Chunk* const neighbours[6], int yBegin, int yEnd, u_int64_t x_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t y_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t z_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2]){
     
-    glm::ivec3 rightNeightbour = chunkCoord + neighbourChunks[0];
-    auto it = chunkMap.find(rightNeightbour);
-    if (it != chunkMap.end()) {
-        for(int y=0; y<CHUNK_SIZE; y++){
+    const Chunk* rightNeightbour = neighbours[0];
+    if (rightNeightbour) {
+        for(int y=yBegin; y<yEnd; y++){
             for(int z=0; z<CHUNK_SIZE; z++){
-                if (it->second.blocks[0][y][z].type != 0) {
+                if (rightNeightbour->blocks[0][y][z].type != 0) {
                     x_solid_mask[y+1][z+1] |= (1ULL << (CHUNK_SIZE+1)); // 0th index of neighbour goes in CHUNK_SIZE+1 index of current chunk's mask padding
                 }
             }
         }
     }   
 
-    glm::ivec3 leftNeightbour = chunkCoord + neighbourChunks[1];
-    it = chunkMap.find(leftNeightbour);
-    if (it != chunkMap.end()) {
-        for(int y=0; y<CHUNK_SIZE; y++){
+    const Chunk* leftNeightbour = neighbours[1];
+    if (leftNeightbour) {
+        for(int y=yBegin; y<yEnd; y++){
             for(int z=0; z<CHUNK_SIZE; z++){
-                if (it->second.blocks[CHUNK_SIZE-1][y][z].type != 0) {
+                if (leftNeightbour->blocks[CHUNK_SIZE-1][y][z].type != 0) {
                     x_solid_mask[y+1][z+1] |= (1ULL << 0); // CHUNK_SIZE-1 index of neighbour goes in 0th index of current chunk's mask padding
                 }
             }
         }
     }
 
-    glm::ivec3 topNeightbour = chunkCoord + neighbourChunks[2];
-    it = chunkMap.find(topNeightbour);
-    if (it != chunkMap.end()) {
+    // the chunks above and below only matter when the range reaches them
+    const Chunk* topNeightbour = neighbours[2];
+    if (topNeightbour && yEnd == CHUNK_SIZE) {
         for(int x=0; x<CHUNK_SIZE; x++){
             for(int z=0; z<CHUNK_SIZE; z++){
-                if (it->second.blocks[x][0][z].type != 0) {
+                if (topNeightbour->blocks[x][0][z].type != 0) {
                     y_solid_mask[x+1][z+1] |= (1ULL << (CHUNK_SIZE+1)); 
                 }
             }
         }
     }
 
-    glm::ivec3 bottomNeightbour = chunkCoord + neighbourChunks[3];
-    it = chunkMap.find(bottomNeightbour);
-    if (it != chunkMap.end()) {
+    const Chunk* bottomNeightbour = neighbours[3];
+    if (bottomNeightbour && yBegin == 0) {
         for(int x=0; x<CHUNK_SIZE; x++){
             for(int z=0; z<CHUNK_SIZE; z++){
-                if (it->second.blocks[x][CHUNK_SIZE-1][z].type != 0) {
+                if (bottomNeightbour->blocks[x][CHUNK_SIZE-1][z].type != 0) {
                     y_solid_mask[x+1][z+1] |= (1ULL << 0); 
                 }
             }
         }
     }
 
-    glm::ivec3 backNeightbour = chunkCoord + neighbourChunks[4];
-    it = chunkMap.find(backNeightbour);
-    if (it != chunkMap.end()) {
+    const Chunk* backNeightbour = neighbours[4];
+    if (backNeightbour) {
         for(int x=0; x<CHUNK_SIZE; x++){
-            for(int y=0; y<CHUNK_SIZE; y++){
-                if (it->second.blocks[x][y][0].type != 0) {
+            for(int y=yBegin; y<yEnd; y++){
+                if (backNeightbour->blocks[x][y][0].type != 0) {
                     z_solid_mask[x+1][y+1] |= (1ULL << (CHUNK_SIZE+1)); 
                 }
             }
         }
     }
 
-    glm::ivec3 frontNeightbour = chunkCoord + neighbourChunks[5];
-    it = chunkMap.find(frontNeightbour);
-    if (it != chunkMap.end()) {
+    const Chunk* frontNeightbour = neighbours[5];
+    if (frontNeightbour) {
         for(int x=0; x<CHUNK_SIZE; x++){
-            for(int y=0; y<CHUNK_SIZE; y++){
-                if (it->second.blocks[x][y][CHUNK_SIZE-1].type != 0) {
+            for(int y=yBegin; y<yEnd; y++){
+                if (frontNeightbour->blocks[x][y][CHUNK_SIZE-1].type != 0) {
                     z_solid_mask[x+1][y+1] |= (1ULL << 0); 
                 }
             }
@@ -335,12 +784,15 @@ void World::populateChunkBitMaskPadding(Chunk& chunk, glm::ivec3 chunkCoord, u_i
     }
 }
 
-void World::bitMaskFaceCulling(Chunk& chunk, glm::ivec3 chunkCoord, u_int64_t x_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t y_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t z_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], std::vector<float>& meshData){
+void World::bitMaskFaceCulling(const Chunk& chunk, glm::ivec3 chunkCoord, int yBegin, int yEnd, u_int64_t x_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t y_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t z_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], std::vector<PackedFace>& faces){
     
     u_int64_t FILTER = ((1ULL << CHUNK_SIZE) - 1) << 1; // Mask to ignore the padding bits (0 and CHUNK_SIZE+1)
+    u_int64_t Y_FILTER = ((1ULL << (yEnd - yBegin)) - 1) << (yBegin + 1); // and the blocks outside the y range in y rows
+
+    // every position below is in padded mask space, -1 to get back to the chunk's local block position
     
     // +X and -X faces
-    for(int y=1; y<CHUNK_SIZE+1; y++){
+    for(int y=yBegin+1; y<yEnd+1; y++){
         for(int z=1; z<CHUNK_SIZE+1; z++){
             
             // take a 64-bit row from the bitmask
@@ -350,80 +802,17 @@ void World::bitMaskFaceCulling(Chunk& chunk, glm::ivec3 chunkCoord, u_int64_t x_
             uint64_t rightVisible = (row & ~(row >> 1)) & FILTER;
             uint64_t leftVisible  = (row & ~(row << 1)) & FILTER;
 
-            // iterate and add the visible faces to the mesh data
+            // iterate and add the visible faces
             while(rightVisible){
-                int bit_index = __builtin_ctzll(rightVisible); // Count trailing zeros which gives the index of the least significant set bit
-                int x = bit_index; 
-
-                int faceID = 0;
-                const float* curFace = faceVertices[faceID];
-                const glm::vec3 normal = normals[faceID];
-
-                glm::ivec3 blockPos = chunkCoord + glm::ivec3(x, y, z) - glm::ivec3(1); // -1 for the padding we added while populating the bitmask to make room for neighboring blocks
-                float blockType = static_cast<float>(chunk.blocks[x-1][y-1][z-1].type);
-
-                for (int i = 0; i < 6; ++i) { // 6 vertices per face
-                    int idx = i * 6; // 6 attributes per vertex in face data                    
-
-                    // Vertex position 
-                    float vx = curFace[idx + 0] + blockPos.x;
-                    float vy = curFace[idx + 1] + blockPos.y;
-                    float vz = curFace[idx + 2] + blockPos.z;
-
-                    // Texture coordinates
-                    float ux = curFace[idx + 3];
-                    float uy = curFace[idx + 4];
-                    
-                    // Face ID 
-                    float fid = curFace[idx + 5];
-                    
-
-                    meshData.insert(meshData.end(), {
-                        vx, vy, vz,           // Position
-                        ux, uy,               // UV Coords
-                        fid,                  // Face ID
-                        blockType,            // Block Type
-                        normal.x, normal.y, normal.z // Normal
-                    });
-                }                   
-                rightVisible &= ~(1ULL << bit_index); // Clear the least significant set bit
+                int x = __builtin_ctzll(rightVisible); // Count trailing zeros which gives the index of the least significant set bit
+                faces.push_back(packFace(x-1, y-1, z-1, 0, chunk.blocks[x-1][y-1][z-1].type));
+                rightVisible &= ~(1ULL << x); // Clear the least significant set bit
             }
             
             while(leftVisible){
-                int bit_index = __builtin_ctzll(leftVisible); // Count trailing zeros to find the index of the least significant set bit
-                int x = bit_index; 
-
-                int faceID = 1;
-                const float* curFace = faceVertices[faceID];
-                const glm::vec3 normal = normals[faceID];
-
-                glm::ivec3 blockPos = chunkCoord + glm::ivec3(x, y, z) - glm::ivec3(1); 
-                float blockType = static_cast<float>(chunk.blocks[x-1][y-1][z-1].type);
-
-                for (int i = 0; i < 6; ++i) { // 6 vertices per face
-                    int idx = i * 6; // 6 attributes per vertex in face data                   
-
-                    // Vertex position 
-                    float vx = curFace[idx + 0] + blockPos.x;
-                    float vy = curFace[idx + 1] + blockPos.y;
-                    float vz = curFace[idx + 2] + blockPos.z;
-
-                    // Texture coordinates
-                    float ux = curFace[idx + 3];
-                    float uy = curFace[idx + 4];
-                    
-                    // Face ID 
-                    float fid = curFace[idx + 5];
-
-                    meshData.insert(meshData.end(), {
-                        vx, vy, vz,           // Position
-                        ux, uy,               // UV Coords
-                        fid,                  // Face ID
-                        blockType,            // Block Type
-                        normal.x, normal.y, normal.z // Normal
-                    });
-                }                   
-                leftVisible &= ~(1ULL << bit_index); // Clear the least significant set bit
+                int x = __builtin_ctzll(leftVisible);
+                faces.push_back(packFace(x-1, y-1, z-1, 1, chunk.blocks[x-1][y-1][z-1].type));
+                leftVisible &= ~(1ULL << x);
             }
         }
     }
@@ -433,279 +822,479 @@ void World::bitMaskFaceCulling(Chunk& chunk, glm::ivec3 chunkCoord, u_int64_t x_
         for(int z=1; z<CHUNK_SIZE+1; z++){
             uint64_t row = y_solid_mask[x][z];
 
-            uint64_t topVisible = (row & ~(row >> 1)) & FILTER;
-            uint64_t bottomVisible = (row & ~(row << 1)) & FILTER;
-
+            uint64_t topVisible = (row & ~(row >> 1)) & Y_FILTER;
+            uint64_t bottomVisible = (row & ~(row << 1)) & Y_FILTER;
 
             while(topVisible){
-                int bit_index = __builtin_ctzll(topVisible);
-                int y = bit_index;
-
-                int faceID = 2;
-                const float* curFace = faceVertices[faceID];
-                const glm::vec3 normal = normals[faceID];
-
-                float blockType = static_cast<float>(chunk.blocks[x-1][y-1][z-1].type);
-                glm::ivec3 blockPos = chunkCoord + glm::ivec3(x, y, z) - glm::ivec3(1); 
-
-                for(int i=0; i<6; i++){
-                    int idx = i * 6; // 6 attributes per vertex in face data
-
-                    // Vertex position 
-                    float vx = curFace[idx + 0] + blockPos.x;
-                    float vy = curFace[idx + 1] + blockPos.y;
-                    float vz = curFace[idx + 2] + blockPos.z;
-
-                    // Texture coordinates
-                    float ux = curFace[idx + 3];
-                    float uy = curFace[idx + 4];
-                    
-                    // Face ID 
-                    float fid = curFace[idx + 5];
-
-                    meshData.insert(meshData.end(), {
-                        vx, vy, vz,           // Position
-                        ux, uy,               // UV Coords
-                        fid,                  // Face ID
-                        blockType,            // Block Type
-                        normal.x, normal.y, normal.z // Normal
-                    });                        
-                }
-                topVisible &= ~(1ULL << bit_index);
+                int y = __builtin_ctzll(topVisible);
+                faces.push_back(packFace(x-1, y-1, z-1, 2, chunk.blocks[x-1][y-1][z-1].type));
+                topVisible &= ~(1ULL << y);
             }
 
             while(bottomVisible){
-                int bit_index = __builtin_ctzll(bottomVisible);
-                int y = bit_index;
-
-                glm::ivec3 blockPos = chunkCoord + glm::ivec3(x, y, z) - glm::ivec3(1); 
+                int y = __builtin_ctzll(bottomVisible);
+                bottomVisible &= ~(1ULL << y);
 
                 // Skip the -y faces of blocks at and beyond vertical world limits
-                if (blockPos.y <= -(Y_LIMIT*CHUNK_SIZE)){
-                    bottomVisible &= ~(1ULL << bit_index);
+                if (chunkCoord.y + y-1 <= -(Y_LIMIT*CHUNK_SIZE)){
                     continue; 
                 }
-
-                float blockType = static_cast<float>(chunk.blocks[x-1][y-1][z-1].type);
-
-                int faceID = 3;
-                const float* curFace = faceVertices[faceID];
-                const glm::vec3 normal = normals[faceID];                 
-
-                for (int i = 0; i < 6; ++i) { // 6 vertices per face
-                    int idx = i * 6; // 6 attributes per vertex in face data                   
-
-                    // Vertex position 
-                    float vx = curFace[idx + 0] + blockPos.x;
-                    float vy = curFace[idx + 1] + blockPos.y;
-                    float vz = curFace[idx + 2] + blockPos.z;
-
-                    // Texture coordinates
-                    float ux = curFace[idx + 3];
-                    float uy = curFace[idx + 4];
-                    
-                    // Face ID 
-                    float fid = curFace[idx + 5];
-
-                    meshData.insert(meshData.end(), {
-                        vx, vy, vz,           // Position
-                        ux, uy,               // UV Coords
-                        fid,                  // Face ID
-                        blockType,            // Block Type
-                        normal.x, normal.y, normal.z // Normal
-                    });
-                }   
-
-                bottomVisible &= ~(1ULL << bit_index);
+                faces.push_back(packFace(x-1, y-1, z-1, 3, chunk.blocks[x-1][y-1][z-1].type));
             }
         }
     }
 
     // +Z and -Z faces
     for(int x=1; x<CHUNK_SIZE+1; x++){
-        for(int y=1; y<CHUNK_SIZE+1; y++){
+        for(int y=yBegin+1; y<yEnd+1; y++){
             uint64_t row = z_solid_mask[x][y];
 
             uint64_t backVisible = (row & ~(row >> 1)) & FILTER;
             uint64_t frontVisible = (row & ~(row << 1)) & FILTER;
 
             while(backVisible){
-                int bit_index = __builtin_ctzll(backVisible);
-                int z = bit_index;
+                int z = __builtin_ctzll(backVisible);
+                faces.push_back(packFace(x-1, y-1, z-1, 4, chunk.blocks[x-1][y-1][z-1].type));
+                backVisible &= ~(1ULL << z);
+            }
 
-                int faceID = 4;
-                const float* curFace = faceVertices[faceID];
-                const glm::vec3 normal = normals[faceID]; 
+            while(frontVisible){
+                int z = __builtin_ctzll(frontVisible);
+                faces.push_back(packFace(x-1, y-1, z-1, 5, chunk.blocks[x-1][y-1][z-1].type));
+                frontVisible &= ~(1ULL << z);
+            }
+        }
+    }             
 
-                glm::ivec3 blockPos = chunkCoord + glm::ivec3(x, y, z) - glm::ivec3(1); 
-                float blockType = static_cast<float>(chunk.blocks[x-1][y-1][z-1].type);
+}
 
-                for (int i = 0; i < 6; ++i) { // 6 vertices per face
-                    int idx = i * 6; // 6 attributes per vertex in face data                    
+void World::buildChunkFaces(const Chunk& chunk, glm::ivec3 chunkCoord, const Chunk* const neighbours[6], std::vector<PackedFace>& faces,
+                            int sectionBegin, int sectionEnd) {
+    PROFILE_ZONE("Build faces");
+    // bitmask arrays where a bit represents a solid block 0 represents air
+    // we define the chunk in 3 different orientations(x, y, z) to make it easier to make it easier to 
+    // iterate and cull faces accross all three axises
+    u_int64_t x_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2] = {0}; // +2 for the padding
+    u_int64_t y_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2] = {0};
+    u_int64_t z_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2] = {0};
 
-                    // Vertex position 
-                    float vx = curFace[idx + 0] + blockPos.x;
-                    float vy = curFace[idx + 1] + blockPos.y;
-                    float vz = curFace[idx + 2] + blockPos.z;
+    int yBegin = sectionBegin * SECTION_HEIGHT;
+    int yEnd = sectionEnd * SECTION_HEIGHT;
 
-                    // Texture coordinates
-                    float ux = curFace[idx + 3];
-                    float uy = curFace[idx + 4];
-                    
-                    // Face ID 
-                    float fid = curFace[idx + 5];
-                    
+    // populate the bitmask arrays with current chunk data
+    populateChunkBitMask(chunk, yBegin, yEnd, x_solid_mask, y_solid_mask, z_solid_mask);
 
-                    meshData.insert(meshData.end(), {
-                        vx, vy, vz,           // Position
-                        ux, uy,               // UV Coords
-                        fid,                  // Face ID
-                        blockType,            // Block Type
-                        normal.x, normal.y, normal.z // Normal
-                    });
-                }   
+    // populate the bitmask padding with neighbor chunk data to allow proper face culling at chunk borders
+    populateChunkBitMaskPadding(neighbours, yBegin, yEnd, x_solid_mask, y_solid_mask, z_solid_mask);
 
-                backVisible &= ~(1ULL << bit_index);
-            }
+    // use the bitmask arrays to determine which faces of each block are visible and should be included in the mesh
+    bitMaskFaceCulling(chunk, chunkCoord, yBegin, yEnd, x_solid_mask, y_solid_mask, z_solid_mask, faces);
+}
 
-            while(frontVisible){
-                int bit_index = __builtin_ctzll(frontVisible);
-                int z = bit_index;
-                
-                int faceID = 5;
-                const float* curFace = faceVertices[faceID];
-                const glm::vec3 normal = normals[faceID]; 
-
-                glm::ivec3 blockPos = chunkCoord + glm::ivec3(x, y, z) - glm::ivec3(1); 
-                float blockType = static_cast<float>(chunk.blocks[x-1][y-1][z-1].type);
-
-                for (int i = 0; i < 6; ++i) { // 6 vertices per face
-                    int idx = i * 6; // 6 attributes per vertex in face data
-
-                    // Vertex position 
-                    float vx = curFace[idx + 0] + blockPos.x;
-                    float vy = curFace[idx + 1] + blockPos.y;
-                    float vz = curFace[idx + 2] + blockPos.z;
-
-                    // Texture coordinates
-                    float ux = curFace[idx + 3];
-                    float uy = curFace[idx + 4];
-                    
-                    // Face ID and Block Type
-                    float fid = curFace[idx + 5];
-                    
-
-                    meshData.insert(meshData.end(), {
-                        vx, vy, vz,           // Position
-                        ux, uy,               // UV Coords
-                        fid,                  // Face ID
-                        blockType,            // Block Type
-                        normal.x, normal.y, normal.z // Normal
-                    });
-                }   
-
-                frontVisible &= ~(1ULL << bit_index);
-            }
-        
-        }
-    }             
+void World::expandChunkFaces(const std::vector<PackedFace>& faces, glm::ivec3 chunkCoord, ChunkMesh& mesh) {
+    PROFILE_ZONE("Expand faces");
+    constexpr int FLOATS_PER_FACE = 6 * VERTEX_FLOATS; // 6 verts per face
+
+    // faces come in culling order (cached ones too), counted per section first so each section gets one contiguous range
+    int sectionFaces[CHUNK_SECTIONS] = {0};
+    for (PackedFace face : faces) {
+        sectionFaces[unpackFaceSection(face)]++;
+    }
+    size_t sectionOffset[CHUNK_SECTIONS]; // in floats
+    size_t offset = 0;
+    for (int section = mesh.sectionBegin; section < mesh.sectionEnd; section++) {
+        sectionOffset[section] = offset;
+        offset += sectionFaces[section] * FLOATS_PER_FACE;
+        mesh.sectionVertices[section] = sectionFaces[section] * 6;
+    }
+    mesh.vertices.resize(offset);
+
+    for (PackedFace face : faces) {
+        int faceID = unpackFaceID(face);
+        const float* curFace = faceVertices[faceID];
+        const glm::vec3 normal = normals[faceID];
+
+        glm::ivec3 blockPos = chunkCoord + unpackFacePosition(face);
+        float blockType = static_cast<float>(unpackFaceType(face));
+        mesh.boundsMin = glm::min(mesh.boundsMin, glm::vec3(blockPos) - 0.5f);
+        mesh.boundsMax = glm::max(mesh.boundsMax, glm::vec3(blockPos) + 0.5f);
+
+        size_t& out = sectionOffset[unpackFaceSection(face)];
+        for (int i = 0; i < 6; ++i) { // 6 vertices per face
+            int idx = i * 6; // 6 attributes per vertex in face data                    
+            float* vertex = &mesh.vertices[out];
+            out += VERTEX_FLOATS;
+
+            // Vertex position 
+            vertex[0] = curFace[idx + 0] + blockPos.x;
+            vertex[1] = curFace[idx + 1] + blockPos.y;
+            vertex[2] = curFace[idx + 2] + blockPos.z;
+
+            // Texture coordinates
+            vertex[3] = curFace[idx + 3];
+            vertex[4] = curFace[idx + 4];
+            
+            // Face ID 
+            vertex[5] = curFace[idx + 5];
 
+            vertex[6] = blockType;
+
+            // Normal
+            vertex[7] = normal.x;
+            vertex[8] = normal.y;
+            vertex[9] = normal.z;
+        }
+    }
 }
 
-void World::calculateChunkMesh(glm::ivec3 chunkCoord) {
+void World::calculateChunkMesh(glm::ivec3 chunkCoord, int sectionBegin, int sectionEnd, std::shared_ptr<PendingEdit> edit) {
+    PROFILE_ZONE("calculateChunkMesh");
 
-    std::vector<float> meshData;
-    constexpr int FLOATS_PER_FACE = 6 * 10; // 6 verts, 10 floats each
+    std::vector<PackedFace> faces;
     const int FACES_PER_XZ_CELL_EST = 2; // calculated guess
-    meshData.reserve(FLOATS_PER_FACE * FACES_PER_XZ_CELL_EST * CHUNK_SIZE * CHUNK_SIZE);
+    faces.reserve(FACES_PER_XZ_CELL_EST * CHUNK_SIZE * CHUNK_SIZE * (sectionEnd - sectionBegin) / CHUNK_SECTIONS);
+    bool firstMesh = false;
+    bool cacheMesh = false;
+    ChunkMesh mesh;
 
     {
         std::unique_lock<std::shared_mutex> lock(chunkMapMutex);
 
         // Ensure the chunk exists in the map
-        if (chunkMap.find(chunkCoord) == chunkMap.end()) {
-            return; // Cannot mesh a chunk that hasn't had its block data generated
+        auto it = chunkMap.find(chunkCoord);
+        if (it == chunkMap.end()) {
+            // Cannot mesh a chunk that hasn't had its block data generated
+            if (edit) {
+                threadpool->enqueuePriorityMainTask([this, edit]{ completeEditChunk(edit, 0); });
+            }
+            return;
+        }
+
+        Chunk& chunk = *it->second;
+        firstMesh = !chunk.meshBuilt;
+        chunk.meshBuilt = true;
+        // a chunk without a mesh on its way yet gets all of it
+        if (firstMesh) {
+            sectionBegin = 0;
+            sectionEnd = CHUNK_SECTIONS;
+        }
+        mesh.sectionBegin = sectionBegin;
+        mesh.sectionEnd = sectionEnd;
+        mesh.version = ++chunk.meshVersion;
+
+        // missing neighbours are treated as air
+        const Chunk* neighbours[6];
+        bool neighboursUntouched = true; // all there and straight from the generator
+        for (int i = 0; i < 6; i++) {
+            glm::ivec3 neighbourCoord = chunkCoord + neighbourChunks[i];
+            auto neighbour = chunkMap.find(neighbourCoord);
+            neighbours[i] = (neighbour != chunkMap.end()) ? neighbour->second.get() : nullptr;
+
+            bool outsideWorld = neighbourCoord.y < -(Y_LIMIT*CHUNK_SIZE) || neighbourCoord.y > Y_LIMIT*CHUNK_SIZE;
+            if (neighbours[i] ? neighbours[i]->edited : !outsideWorld) {
+                neighboursUntouched = false;
+            }
         }
 
-        Chunk& chunk = chunkMap.at(chunkCoord);
+        buildChunkFaces(chunk, chunkCoord, neighbours, faces, sectionBegin, sectionEnd);
 
-        // bitmask arrays where a bit represents a solid block 0 represents air
-        // we define the chunk in 3 different orientations(x, y, z) to make it easier to make it easier to 
-        // iterate and cull faces accross all three axises
-        u_int64_t x_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2] = {0}; // +2 for the padding
-        u_int64_t y_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2] = {0};
-        u_int64_t z_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2] = {0};
+        // the first mesh of a chunk thats exactly the generator output goes to the chunk cache
+        if (useChunkCache && mesh.isWholeChunk() && !chunk.cached && !chunk.edited && neighboursUntouched) {
+            chunk.cached = true;
+            cacheMesh = true;
+        }
 
-        // populate the bitmask arrays with current chunk data
-        populateChunkBitMask(chunk, chunkCoord, x_solid_mask, y_solid_mask, z_solid_mask);
+        chunk.state = CHUNK_STATE::MESHED; // mark chunk as meshed
+    }
 
-        // populate the bitmask padding with neighbor chunk data to allow proper face culling at chunk borders
-        populateChunkBitMaskPadding(chunk, chunkCoord, x_solid_mask, y_solid_mask, z_solid_mask);
+    // copying and encoding for the cache only reads, so it doesnt hold up other meshing
+    if (cacheMesh) {
+        cacheChunk(chunkCoord, faces);
+    }
 
-        // use the bitmask arrays to determine which faces of each block are visible and should be included in the mesh
-        bitMaskFaceCulling(chunk, chunkCoord, x_solid_mask, y_solid_mask, z_solid_mask, meshData);
+    // expanding to full vertices doesnt need the chunk data, so it happens outside the lock
+    expandChunkFaces(faces, chunkCoord, mesh);
+    queueChunkUpload(chunkCoord, mesh, firstMesh, std::move(edit));
+    meshedChunkCount++;
+}
 
-        chunk.state = CHUNK_STATE::MESHED; // mark chunk as meshed
+void World::queueChunkUpload(glm::ivec3 chunkCoord, ChunkMesh& mesh, bool firstMesh, std::shared_ptr<PendingEdit> edit) {
+    bool countsForStartup = firstMesh && isInStartupArea(chunkCoord);
+
+    // an empty mesh still goes through, the renderer needs to tell an empty chunk from one that isnt meshed yet (and drop an old mesh)
+    size_t bytes = mesh.vertices.size() * sizeof(float);
+    if (edit) {
+        // edits skip the generation uploads waiting on the budget, the section versions keep an older queued mesh from undoing them
+        threadpool->enqueuePriorityMainTask([this, chunkCoord, countsForStartup, edit = std::move(edit), mesh = std::move(mesh)]() mutable {
+            completeEditChunk(edit, uploadChunkMesh(chunkCoord, mesh));
+            if (countsForStartup) {
+                startupReadyChunks++;
+            }
+        }, bytes);
+        return;
     }
+    threadpool->enqueueMainTask([this, chunkCoord, countsForStartup, mesh = std::move(mesh)]() mutable {
+        uploadChunkMesh(chunkCoord, mesh);
+        if (countsForStartup) {
+            startupReadyChunks++;
+        }
+    }, bytes);
+}
 
+bool World::isInStartupArea(glm::ivec3 chunkCoord) {
+    int cx = chunkIndexOf(chunkCoord.x - startupOrigin.x);
+    int cz = chunkIndexOf(chunkCoord.z - startupOrigin.z);
+    return cx * cx + cz * cz <= XZ_RENDER_DIST * XZ_RENDER_DIST;
+}
 
+int World::countStartupChunks() {
+    // same cylinder the renderer draws
+    int columns = 0;
+    for (int cx = -XZ_RENDER_DIST; cx <= XZ_RENDER_DIST; cx++) {
+        for (int cz = -XZ_RENDER_DIST; cz <= XZ_RENDER_DIST; cz++) {
+            if (cx * cx + cz * cz <= XZ_RENDER_DIST * XZ_RENDER_DIST) {
+                columns++;
+            }
+        }
+    }
+    return columns * (Y_LIMIT * 2 + 1);
+}
 
-    if (!meshData.empty()) {
-        meshData.shrink_to_fit(); 
-        threadpool->enqueueMainTask([this, chunkCoord, meshData = std::move(meshData)]() mutable {
-            uploadChunkMesh(chunkCoord, meshData);
-        });
+int World::findRenderRecord(glm::ivec3 chunkOrigin) const {
+    auto it = chunkRenderIndex.find(chunkOrigin);
+    return it != chunkRenderIndex.end() ? it->second : -1;
+}
+
+ChunkRenderRecord& World::getRenderRecord(glm::ivec3 chunkOrigin) {
+    auto it = chunkRenderIndex.find(chunkOrigin);
+    if (it != chunkRenderIndex.end()) {
+        return chunkRenderRecords[it->second];
     }
+    chunkRenderIndex[chunkOrigin] = static_cast<int>(chunkRenderRecords.size());
+    ChunkRenderRecord& record = chunkRenderRecords.emplace_back();
+    record.chunkOrigin = chunkOrigin;
+    return record;
 }
 
-void World::uploadChunkMesh(glm::ivec3 chunkCoord, std::vector<float>& meshData) {
+size_t World::uploadChunkMesh(glm::ivec3 chunkCoord, ChunkMesh& mesh) {
+    PROFILE_ZONE("Upload chunk mesh");
+
+    ChunkRenderRecord& record = getRenderRecord(chunkCoord);
+
+    // meshes can reach the main thread out of order (edits jump the worker queue), a section only takes a newer mesh than it has
+    bool apply[CHUNK_SECTIONS] = {false};
+    bool applyAll = true;
+    bool applyAny = false;
+    const float* sectionData[CHUNK_SECTIONS] = {nullptr};
+    const float* data = mesh.vertices.data();
+    for (int section = 0; section < CHUNK_SECTIONS; section++) {
+        if (section >= mesh.sectionBegin && section < mesh.sectionEnd) {
+            apply[section] = mesh.version > record.sectionVersion[section];
+            sectionData[section] = data;
+            data += mesh.sectionVertices[section] * VERTEX_FLOATS;
+        }
+        applyAll = applyAll && apply[section];
+        applyAny = applyAny || apply[section];
+    }
+    if (!applyAny) {
+        return 0;
+    }
 
-    GLuint chunkVAO, chunkVBO;
-    // Check if the chunk already has a VAO/VBO.
-    if (chunkVaoMap.find(chunkCoord) == chunkVaoMap.end()) {
-        renderer.initWorldObjects(chunkVAO, chunkVBO, chunkCoord, *this);
+    size_t uploaded = 0;
+    if (applyAll) {
+        // the whole chunk, tightly packed since most chunks never get edited
+        int vertices = 0;
+        for (int section = 0; section < CHUNK_SECTIONS; section++) {
+            record.sectionFirst[section] = vertices;
+            record.sectionVertices[section] = mesh.sectionVertices[section];
+            record.sectionCapacity[section] = mesh.sectionVertices[section];
+            record.sectionVersion[section] = mesh.version;
+            vertices += mesh.sectionVertices[section];
+        }
+        record.boundsMin = mesh.boundsMin;
+        record.boundsMax = mesh.boundsMax;
+
+        // empty chunks never get a VAO, one that became empty keeps it but gives up the storage
+        if (vertices > 0 || record.vao) {
+            if (record.vao == 0) {
+                renderer.initWorldObjects(record);
+            } else {
+                glBindBuffer(GL_ARRAY_BUFFER, record.vbo);
+            }
+            glBufferData(GL_ARRAY_BUFFER, vertices * VERTEX_BYTES, mesh.vertices.data(), GL_DYNAMIC_DRAW);
+            chunkMeshBytes = chunkMeshBytes - record.bufferVertices * VERTEX_BYTES + vertices * VERTEX_BYTES;
+            record.bufferVertices = vertices;
+            uploaded = vertices * VERTEX_BYTES;
+        }
     } else {
-        // The chunk already exists, so just get its VBO handle for updating.
-        chunkVBO = chunkVboMap.at(chunkCoord);
-        glBindBuffer(GL_ARRAY_BUFFER, chunkVBO);
+        // a chunk without a VBO only fits sections that stay empty
+        bool fits = true;
+        for (int section = 0; section < CHUNK_SECTIONS; section++) {
+            if (apply[section] && mesh.sectionVertices[section] > (record.vao ? record.sectionCapacity[section] : 0)) {
+                fits = false;
+            }
+        }
+
+        if (fits) {
+            // just the changed sections, in place
+            if (record.vao) {
+                glBindBuffer(GL_ARRAY_BUFFER, record.vbo);
+            }
+            for (int section = 0; section < CHUNK_SECTIONS; section++) {
+                if (!apply[section]) {
+                    continue;
+                }
+                size_t bytes = mesh.sectionVertices[section] * VERTEX_BYTES;
+                if (bytes > 0) {
+                    glBufferSubData(GL_ARRAY_BUFFER, record.sectionFirst[section] * VERTEX_BYTES, bytes, sectionData[section]);
+                }
+                uploaded += bytes;
+            }
+            editStats.sectionUploads++;
+        } else {
+            // a section outgrew its range: a new buffer with room to grow in every section, the others are copied over on the GPU
+            const int SLACK_VERTICES = 6 * 32; // 32 faces
+            int first[CHUNK_SECTIONS];
+            int capacity[CHUNK_SECTIONS];
+            int vertices = 0;
+            for (int section = 0; section < CHUNK_SECTIONS; section++) {
+                int count = apply[section] ? mesh.sectionVertices[section] : record.sectionVertices[section];
+                first[section] = vertices;
+                capacity[section] = count + count / 4 + SLACK_VERTICES;
+                vertices += capacity[section];
+            }
+
+            GLuint oldVbo = record.vbo;
+            renderer.initWorldObjects(record); // new VBO, the VAO is kept
+            glBufferData(GL_ARRAY_BUFFER, vertices * VERTEX_BYTES, nullptr, GL_DYNAMIC_DRAW);
+            if (oldVbo) {
+                glBindBuffer(GL_COPY_READ_BUFFER, oldVbo);
+            }
+            for (int section = 0; section < CHUNK_SECTIONS; section++) {
+                if (apply[section]) {
+                    size_t bytes = mesh.sectionVertices[section] * VERTEX_BYTES;
+                    if (bytes > 0) {
+                        glBufferSubData(GL_ARRAY_BUFFER, first[section] * VERTEX_BYTES, bytes, sectionData[section]);
+                    }
+                    uploaded += bytes;
+                } else if (record.sectionVertices[section] > 0) {
+                    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_ARRAY_BUFFER, record.sectionFirst[section] * VERTEX_BYTES,
+                                        first[section] * VERTEX_BYTES, record.sectionVertices[section] * VERTEX_BYTES);
+                }
+                record.sectionFirst[section] = first[section];
+                record.sectionCapacity[section] = capacity[section];
+            }
+            if (oldVbo) {
+                glDeleteBuffers(1, &oldVbo);
+            }
+            chunkMeshBytes = chunkMeshBytes - record.bufferVertices * VERTEX_BYTES + vertices * VERTEX_BYTES;
+            record.bufferVertices = vertices;
+            editStats.relayouts++;
+        }
+
+        for (int section = 0; section < CHUNK_SECTIONS; section++) {
+            if (apply[section]) {
+                record.sectionVertices[section] = mesh.sectionVertices[section];
+                record.sectionVersion[section] = mesh.version;
+            }
+        }
+        if (mesh.boundsMin.x <= mesh.boundsMax.x) { // not empty
+            record.boundsMin = glm::min(record.boundsMin, mesh.boundsMin);
+            record.boundsMax = glm::max(record.boundsMax, mesh.boundsMax);
+        }
     }
 
-    // update vertex count on main thread
-    chunkVertexCountMap[chunkCoord] = meshData.size() / 10; // 10 floats per vertex
-    
-    // Upload the new vertex data to the VBO
-    if (chunkVertexCountMap[chunkCoord]) {
-        glBufferData(GL_ARRAY_BUFFER, meshData.size() * sizeof(float), meshData.data(), GL_DYNAMIC_DRAW);
+    record.vertexCount = 0;
+    for (int section = 0; section < CHUNK_SECTIONS; section++) {
+        record.vertexCount += record.sectionVertices[section];
     }
+    return uploaded;
 }
 
-void World::init(glm::vec3& playerPosition, Threadpool* threadpoolPtr) {
-    
+void World::completeEditChunk(const std::shared_ptr<PendingEdit>& edit, size_t bytes) {
+    edit->uploadBytes += bytes;
+    if (--edit->remainingChunks > 0) {
+        return;
+    }
+    float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - edit->start).count();
+    editStats.lastMs = ms;
+    editStats.averageMs = editStats.edits == 0 ? ms : editStats.averageMs + (ms - editStats.averageMs) * 0.2f;
+    editStats.maxMs = std::max(editStats.maxMs, ms);
+    editStats.lastBytes = edit->uploadBytes;
+    editStats.edits++;
+
+    u_int64_t frames = frameCounter - edit->startFrame;
+    if (frames == 0) {
+        editStats.sameFrame++;
+    } else if (frames == 1) {
+        editStats.nextFrame++;
+    } else {
+        editStats.later++;
+    }
+}
+
+void World::initGenerator() {
     // Configure the noise generator
     warpNoise.SetDomainWarpType(FastNoiseLite::DomainWarpType_OpenSimplex2);
+    warpNoise.SetSeed(g_NoiseSeed);
     warpNoise.SetDomainWarpAmp(25.0f); 
     warpNoise.SetFrequency(0.005f); 
 
     // The Base Noise
     baseNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
+    baseNoise.SetSeed(g_NoiseSeed);
     baseNoise.SetFractalType(FastNoiseLite::FractalType_FBm);
     baseNoise.SetFractalOctaves(4);
     baseNoise.SetFrequency(0.003f); 
 
+    // Caves
+    caveNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
+    caveNoise.SetSeed(g_NoiseSeed + 3);
+    caveNoise.SetFrequency(0.0125f);
+
+    // Temperature / moisture
+    biomeMap.init(g_NoiseSeed);
+    heightmapCache.clear();
+}
+
+void World::init(glm::vec3& playerPosition, Threadpool* threadpoolPtr) {
+
+    initGenerator();
+
     // Position the player above the terrain at (0,0)
-    warpNoise.DomainWarp(playerPosition.x, playerPosition.z);
-    float noiseVal = baseNoise.GetNoise(playerPosition.x, playerPosition.z);
-    playerPosition.y = 66 + static_cast<int>(noiseVal * 30.0f); 
+    int spawnX = static_cast<int>(glm::round(playerPosition.x));
+    int spawnZ = static_cast<int>(glm::round(playerPosition.z));
+    playerPosition.y = static_cast<float>(getTerrainHeight(spawnX, spawnZ) + 2);
 
 
     threadpool = threadpoolPtr;
+    startupOrigin = getChunkOrigin(glm::round(playerPosition));
+    startupReadyChunks = 0;
+    startupChunkTarget = countStartupChunks();
+
+    regionStore.init(saveDirectory, g_NoiseSeed, Y_LIMIT*2+1);
+    if (useChunkCache) {
+        // keyed by seed and generator version, switching either starts a fresh cache instead of thrashing this one
+        std::string cacheDirectory = saveDirectory + "/cache/" + std::to_string(g_NoiseSeed) + "-v" + std::to_string(GENERATOR_VERSION);
+        chunkCache.init(cacheDirectory, g_NoiseSeed, Y_LIMIT*2+1, true);
+    }
+    if (journalEdits) {
+        editJournal.open(saveDirectory, g_NoiseSeed);
+    }
 
     // Generate the initial terrain around the player
     generateChunks(playerPosition);       
 }
 
 void World::cleanup() {
+    flushDirtyChunks();
+    editJournal.close();
+
     // Delete all OpenGL objects
-    for (auto& pair : chunkVboMap) glDeleteBuffers(1, &pair.second);
-    for (auto& pair : chunkVaoMap) glDeleteVertexArrays(1, &pair.second);
+    for (ChunkRenderRecord& record : chunkRenderRecords) {
+        if (record.vao) {
+            glDeleteBuffers(1, &record.vbo);
+            glDeleteVertexArrays(1, &record.vao);
+        }
+    }
 }
\ No newline at end of file
@@ -7,8 +7,16 @@
 #include <FastNoiseLite/FastNoiseLite.h>
 #include <core/constants.h>
 #include <core/utils.h>
+#include <core/lru_cache.h>
+#include <core/flat_map.h>
+#include <core/profiler.h>
 #include <renderer/renderer.h>
 #include <threadpool/threadpool.h>
+#include <world/biome.h>
+#include <world/chunk.h>
+#include <world/edit_journal.h>
+#include <world/region.h>
+#include <cfloat>
 #include <chrono>
 #include <queue>
 #include <thread>
@@ -16,28 +24,93 @@
 #include <mutex>
 #include <shared_mutex>
 #include <condition_variable>
+#include <memory>
+#include <atomic>
+#include <string>
+#include <unordered_set>
 
 
 // Forward declaration
 class Player; 
 
-// BLOCK
-struct Block{
-    u_int8_t type = 0;
+// COLUMN HEIGHTMAP
+// surface height and biome of every x,z column in a chunk column, shared by all the vertically stacked chunks
+struct ColumnHeightmap {
+    int heights[CHUNK_SIZE][CHUNK_SIZE];
+    BIOME biomes[CHUNK_SIZE][CHUNK_SIZE];
+    int minHeight;
+    int maxHeight;
 };
 
+// COLUMN SPANS
+// a single x,z column of a chunk as runs of layers, in local y [begin, end) bounds
+// the runs are stacked bottom to top: stone, subsurface, surface, then air up to CHUNK_SIZE
+struct ColumnSpans {
+    int stoneBegin;
+    int stoneEnd;       // == subsurface begin
+    int subsurfaceEnd;  // == surface begin
+    int surfaceEnd;     // == air begin
+    u_int8_t subsurfaceBlock;
+    u_int8_t surfaceBlock;
+};
+
+
+constexpr int VERTEX_FLOATS = 10; // position, uv, face id, block type, normal
+constexpr size_t VERTEX_BYTES = VERTEX_FLOATS * sizeof(float);
+
+// CHUNK MESH
+// vertices of the sections [sectionBegin, sectionEnd) of a chunk, grouped by section in order
+struct ChunkMesh {
+    std::vector<float> vertices;
+    int sectionVertices[CHUNK_SECTIONS] = {};
+    int sectionBegin = 0;
+    int sectionEnd = CHUNK_SECTIONS;
+    u_int32_t version = 0;          // Chunk::meshVersion it was built from
+    glm::vec3 boundsMin = glm::vec3(FLT_MAX);
+    glm::vec3 boundsMax = glm::vec3(-FLT_MAX);
+
+    bool isWholeChunk() const { return sectionBegin == 0 && sectionEnd == CHUNK_SECTIONS; }
+};
+
+// RENDER RECORD
+// everything the renderer needs to draw one chunk, so culling a chunk costs one lookup instead of one per map
+// the sections sit in one VBO, each in its own range, drawn with a single glMultiDrawArrays
+struct ChunkRenderRecord {
+    glm::ivec3 chunkOrigin;
+    GLuint vao = 0;                 // 0 until the chunk had something to draw
+    GLuint vbo = 0;
+    int vertexCount = 0;            // all sections, 0 for meshed chunks with nothing to draw
+    int bufferVertices = 0;         // size of the VBO
+    int sectionFirst[CHUNK_SECTIONS] = {};
+    int sectionVertices[CHUNK_SECTIONS] = {};
+    int sectionCapacity[CHUNK_SECTIONS] = {}; // room in the range, a remesh that fits is a glBufferSubData of just that section
+    u_int32_t sectionVersion[CHUNK_SECTIONS] = {};
+    glm::vec3 boundsMin = glm::vec3(FLT_MAX);   // box around the mesh vertices, tighter than the chunk for most terrain
+    glm::vec3 boundsMax = glm::vec3(-FLT_MAX);  // section updates only grow it, the next whole chunk mesh tightens it again
+    u_int64_t lastVisibleFrame = 0; // renderer frame it last passed culling
+};
 
-// CHUNK STATE
-enum class CHUNK_STATE: u_int8_t{
-    EMPTY       = 0,    // No block data, not generated
-    GENERATED   = 1,    // Block data generated, no mesh
-    MESHED      = 2,    // Mesh generated and uploaded to GPU
+// EDIT TIMING
+// one block edit, from the click until the last chunk it remeshed is on the GPU, counted down on the main thread
+struct PendingEdit {
+    std::chrono::steady_clock::time_point start;
+    u_int64_t startFrame = 0;
+    int remainingChunks = 0;
+    size_t uploadBytes = 0;
 };
 
-// CHUNK
-struct Chunk {
-    Block blocks[CHUNK_SIZE][CHUNK_SIZE][CHUNK_SIZE];
-    CHUNK_STATE state = CHUNK_STATE::EMPTY; 
+struct EditStats {
+    int edits = 0;
+    float lastMs = 0.0f;
+    float averageMs = 0.0f;     // smoothed
+    float maxMs = 0.0f;
+    size_t lastBytes = 0;       // uploaded for the last edit, all its chunks
+    int sectionUploads = 0;     // section updates that fit their range
+    int relayouts = 0;          // a section outgrew its range and the chunk got a new VBO
+    // frames between the click and the upload, 0 means the frame that handled the click already draws it
+    int sameFrame = 0;
+    int nextFrame = 0;
+    int later = 0;
 };
 
 
@@ -47,47 +120,143 @@ class World {
     
         Renderer renderer;
 
-        // Mesh Data
-        std::unordered_map<glm::ivec3, int> chunkVertexCountMap;
-        std::unordered_map<glm::ivec3, GLuint> chunkVboMap;
-        std::unordered_map<glm::ivec3, GLuint> chunkVaoMap;   
+        // Mesh Data, main thread only. A chunk gets its record on its first upload and keeps the index,
+        // records are never removed so indices stay valid across frames
+        std::vector<ChunkRenderRecord> chunkRenderRecords;
+        FlatMap<glm::ivec3, int, ChunkCoordHash> chunkRenderIndex; // chunk origin -> index into chunkRenderRecords, no entry means not meshed yet
+        size_t chunkMeshBytes = 0; // chunk VBOs, including the room sections have to grow after edits
+        EditStats editStats; // main thread only
+        u_int64_t frameCounter = 0; // bumped by the game loop at the start of every frame, edit latency counts frames in it
+        int findRenderRecord(glm::ivec3 chunkOrigin) const; // -1 if the chunk has none yet
 
         // Render and Load Distances
         int Y_LIMIT = 4; // Vertical world limit in chunks (total height in blocks = Y_LIMIT*CHUNK_SIZE)
         int XZ_RENDER_DIST = 45;
         int XZ_LOAD_DIST = XZ_RENDER_DIST+1;     
+
+        // Persistence
+        std::string saveDirectory = "world"; // region files and the edit journal, relative to the working directory (set before init)
+        bool journalEdits = true; // edits go to a journal replayed over generation, false saves whole edited chunks to region files
+        bool useChunkCache = true; // keep generated chunks and their meshes on disk (saveDirectory/cache), so the next launch skips generating and meshing them
+
+        // Load stats, where the chunks came from (startup report)
+        std::atomic<int> generatedChunkCount{0};
+        std::atomic<int> cachedChunkCount{0};   // blocks and mesh from the chunk cache
+        std::atomic<int> storedChunkCount{0};   // from the region files
+        std::atomic<int> meshedChunkCount{0};   // meshes built, remeshes included
+
+        // Startup progress, chunks within XZ_RENDER_DIST of where the world was loaded whose first mesh is on the GPU (or turned out empty)
+        std::atomic<int> startupReadyChunks{0};
+        int startupChunkTarget = 0;             // chunks in that area, set by init
         
         // Lifecycle
         void init(glm::vec3& playerPosition, Threadpool* threadpoolPtr);
-        void cleanup();
+        void initGenerator(); // noise setup only, enough for headless generation
+        void cleanup(); // call after the threadpool stopped, flushes unsaved edits
+        void saveDirtyChunks();  // queues a save of the edits on a worker (and of the chunk cache while the workers are idle)
+        void flushDirtyChunks(bool writeChunkCache = true); // saves on the calling thread
         
         // Accessors
         Block* getBlock(glm::ivec3 blockPosition);
+        const Chunk* getChunk(glm::ivec3 chunkOrigin); // nullptr if not loaded, hold chunkMapMutex while using it
+        void addGeneratedChunk(glm::ivec3 chunkOrigin, Chunk& chunk); // headless use (benchmarks), puts blocks in the map without meshing them
         void setBlock(glm::ivec3 blockPosition, int type);
-        glm::ivec3 getChunkOrigin(glm::ivec3 blockPosition);
+        glm::ivec3 getChunkOrigin(glm::ivec3 blockPosition) const { return chunkOriginOf(blockPosition); }
+        std::shared_ptr<const ColumnHeightmap> getColumnHeightmap(int chunkX, int chunkZ); // x,z of the chunk origin
+        int getTerrainHeight(int x, int z); // surface height at a block column
+        BIOME getBiome(int x, int z);
+        int getNoiseSeed() const { return g_NoiseSeed; }
+        void setNoiseSeed(int seed) { g_NoiseSeed = seed; } // takes effect on the next initGenerator()
+
+        // bump whenever the same seed would generate different blocks, anything stored on disk is keyed on it
+        static constexpr u_int32_t GENERATOR_VERSION = 1;
 
         // Terrain Generation
-        void generateChunks(glm::vec3 playerPosition);  
+        // velocity and view direction bias the order towards where the player looks and will be, zero keeps it radial
+        // a nonzero loadSequence is from requestChunks, a call older than the last one applied is dropped
+        void generateChunks(glm::vec3 playerPosition, glm::vec3 playerVelocity = glm::vec3(0), glm::vec3 viewDirection = glm::vec3(0), u_int64_t loadSequence = 0);
+        void requestChunks(glm::vec3 playerPosition, glm::vec3 playerVelocity, glm::vec3 viewDirection); // runs generateChunks on a worker
         void generateChunkData(glm::ivec3 chunkOrigin); 
-        void updateChunkAndNeighboursMesh(glm::ivec3 block);
+        void generateChunkBlocks(glm::ivec3 chunkOrigin, Chunk& chunk); // pure block generation, touches no shared state except the heightmap cache
+        void fillChunkBlocks(glm::ivec3 chunkOrigin, const ColumnHeightmap& heightmap, Chunk& chunk);
+        void carveCaves(glm::ivec3 chunkOrigin, const ColumnHeightmap& heightmap, Chunk& chunk);
+        ColumnSpans calculateColumnSpans(int chunkY, int height, BIOME biome);
+        // remeshes just the sections the edit touched, call after setBlock. The meshes skip the queued bulk uploads,
+        // editTime is when the click was handled (the start of the measured latency)
+        void updateChunkAndNeighboursMesh(glm::ivec3 block, std::chrono::steady_clock::time_point editTime = std::chrono::steady_clock::now());
         void tryCalculateChunkMesh(glm::ivec3 chunkCoord); // only calculates mesh if chunk state is GENERATED, otherwise does nothing
-        void calculateChunkMesh(glm::ivec3 chunkCoord);
-        void uploadChunkMesh(glm::ivec3 chunkCoord, std::vector<float>& meshData);        
+        // sections [sectionBegin, sectionEnd), the whole chunk if it never had a mesh
+        void calculateChunkMesh(glm::ivec3 chunkCoord, int sectionBegin = 0, int sectionEnd = CHUNK_SECTIONS, std::shared_ptr<PendingEdit> edit = nullptr);
+        // pure meshing, neighbours are in neighbourChunks order and a nullptr neighbour counts as air
+        void buildChunkFaces(const Chunk& chunk, glm::ivec3 chunkCoord, const Chunk* const neighbours[6], std::vector<PackedFace>& faces,
+                             int sectionBegin = 0, int sectionEnd = CHUNK_SECTIONS);
+        void expandChunkFaces(const std::vector<PackedFace>& faces, glm::ivec3 chunkCoord, ChunkMesh& mesh); // faces of the mesh's sections, in any order
+        size_t uploadChunkMesh(glm::ivec3 chunkCoord, ChunkMesh& mesh); // returns the bytes sent to the GPU
+        // hands the mesh to the main thread, counts startup progress and edit latency
+        void queueChunkUpload(glm::ivec3 chunkCoord, ChunkMesh& mesh, bool firstMesh, std::shared_ptr<PendingEdit> edit = nullptr);
 
         std::shared_mutex chunkMapMutex; // chunkMap shared mutex
+        FlatMap<glm::ivec3, std::unique_ptr<Chunk>, ChunkCoordHash>::ProbeStats getChunkMapStats(); // takes the lock, walks the whole table
 
         
     private:        
 
         Threadpool* threadpool;
+        glm::ivec3 startupOrigin = glm::ivec3(0); // player chunk at init
+        bool isInStartupArea(glm::ivec3 chunkCoord);
+        ChunkRenderRecord& getRenderRecord(glm::ivec3 chunkOrigin); // adds one if the chunk has none
+        void completeEditChunk(const std::shared_ptr<PendingEdit>& edit, size_t bytes); // main thread
+        int countStartupChunks();
+
+        // World Data, chunks are boxed so the table stays small and rehashing never moves 36KB of blocks (or a Chunk* someone holds)
+        FlatMap<glm::ivec3, std::unique_ptr<Chunk>, ChunkCoordHash> chunkMap;
+
+        // Load order, built once per load distance instead of sorting every candidate on each chunk crossing
+        // offsets are in chunks from the player chunk (y relative too), nearest first
+        struct LoadOrder {
+            int loadDist = -1;
+            int yLimit = -1;
+            std::vector<glm::ivec3> offsets;        // the whole load cylinder
+            std::vector<glm::ivec3> steps[3][3];    // [dx+1][dz+1], just the columns a one chunk step exposes, same order
+        };
+        LoadOrder loadOrder;
+        glm::ivec3 lastLoadOrigin;      // player chunk of the last generateChunks, everything in its cylinder is queued or loaded
+        bool hasLoadOrigin = false;
+        u_int64_t appliedLoadSequence = 0;          // workers can run requests out of order, an older origin would reopen holes
+        std::atomic<u_int64_t> requestedLoadSequence{0};
+        std::mutex loadOrderMutex;      // generateChunks runs on workers
+        void buildLoadOrder();
+        void prioritizeChunks(std::vector<glm::ivec3>& chunks, glm::ivec3 playerChunkOrigin, glm::vec3 playerVelocity, glm::vec3 viewDirection);
+        bool isStillWanted(glm::ivec3 chunkOrigin); // false once the player moved far enough away before it got generated
+
+        // Directional prefetch
+        const float PREFETCH_SECONDS = 2.0f;        // how far ahead the predicted position is
+        const float VIEW_CONE_COS = 0.5f;           // within 60 degrees of the view direction counts as in view
+        const float VIEW_CONE_BIAS = 0.6f;          // chunks in view are ordered as if they were this much closer
+        bool isInLoadCylinder(int cx, int cz) const { return cx * cx + cz * cz <= XZ_LOAD_DIST * XZ_LOAD_DIST; }
 
-        // World Data
-        std::unordered_map<glm::ivec3, Chunk> chunkMap;
+        // Persistence, stored chunks are loaded instead of generated
+        RegionStore regionStore;
+        EditJournal editJournal; // replayed over every generated or loaded chunk
+        std::unordered_set<glm::ivec3> dirtyChunks; // edited since the last save (region file mode only), guarded by chunkMapMutex
+        std::mutex saveMutex; // one save at a time, so an older snapshot never lands after a newer one
+
+        // Chunk cache, blocks plus packed meshes of chunks exactly as the generator made them
+        RegionStore chunkCache;
+        std::unordered_map<glm::ivec2, std::vector<StoredChunk>> pendingCacheChunks; // meshed but not written yet, by region
+        size_t pendingCacheChunkCount = 0; // guarded by cacheMutex
+        const size_t MAX_PENDING_CACHE_CHUNKS = 8192; // ~15 MB at the average size, past this new ones are dropped until an idle save writes them
+        std::mutex cacheMutex;
+        void cacheChunk(glm::ivec3 chunkOrigin, const std::vector<PackedFace>& faces); // takes the shared chunk map lock
+        void flushChunkCache(); // only from the background save once generation has settled, and on exit
+        bool canUseCachedMesh(glm::ivec3 chunkOrigin); // false if the chunk or a neighbour may differ from the generator output
+        std::atomic<bool> savePending{false};
 
         // Bitmasking helpers for Face Culling
-        void populateChunkBitMask(Chunk& chunk, glm::ivec3 chunkCoord, u_int64_t x_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t y_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t z_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2]);
-        void populateChunkBitMaskPadding(Chunk& chunk, glm::ivec3 chunkCoord, u_int64_t x_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t y_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t z_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2]);
-        void bitMaskFaceCulling(Chunk& chunk, glm::ivec3 chunkCoord, u_int64_t x_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t y_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t z_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], std::vector<float>& meshData);
+        // all three take the local y range [yBegin, yEnd) the faces are wanted for
+        void populateChunkBitMask(const Chunk& chunk, int yBegin, int yEnd, u_int64_t x_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t y_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t z_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2]);
+        void populateChunkBitMaskPadding(const Chunk* const neighbours[6], int yBegin, int yEnd, u_int64_t x_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t y_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t z_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2]);
+        void bitMaskFaceCulling(const Chunk& chunk, glm::ivec3 chunkCoord, int yBegin, int yEnd, u_int64_t x_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t y_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], u_int64_t z_solid_mask[CHUNK_SIZE+2][CHUNK_SIZE+2], std::vector<PackedFace>& faces);
 
         // Neighbor chunk offsets 
         const glm::ivec3 neighbourChunks[6] = {
@@ -120,6 +289,23 @@ class World {
         int   g_NoiseSeed       = 133;        
 
         FastNoiseLite warpNoise;
+
+        BiomeMap biomeMap; // drives the height parameters and surface blocks
+
+        // Caves, 3D density noise sampled on a coarse lattice and trilinearly interpolated per block
+        FastNoiseLite caveNoise;
+        static constexpr int   CAVE_LATTICE_XZ  = 8;        // blocks between lattice nodes, must divide CHUNK_SIZE
+        static constexpr int   CAVE_LATTICE_Y   = 8;
+        static constexpr int   CAVE_NODES_XZ    = CHUNK_SIZE / CAVE_LATTICE_XZ + 1;
+        static constexpr int   CAVE_NODES_Y     = CHUNK_SIZE / CAVE_LATTICE_Y + 1;
+        static constexpr float CAVE_THRESHOLD   = 0.75f;    // carve where density is above this
+        static constexpr int   CAVE_FLOOR_DEPTH = 32;       // no caves in the bottom chunk of the world
+
+        // Column heightmaps, so the noise is only sampled once per column instead of once per vertical chunk
+        // generation runs roughly in distance order so only a thin ring of columns is live at a time
+        static constexpr size_t HEIGHTMAP_CACHE_SIZE = 1024;
+        LruCache<glm::ivec2, std::shared_ptr<const ColumnHeightmap>> heightmapCache{HEIGHTMAP_CACHE_SIZE};
+        std::shared_ptr<const ColumnHeightmap> calculateColumnHeightmap(int chunkX, int chunkZ);
     };
     
     
@@ -0,0 +1,236 @@
+#include <world/world.h>
+#include <world/region.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// Headless world pre-generation, writes region files for a rectangle of chunk columns
+// usage: pregen [--threads N] [--seed S] [--mesh] [--out DIR] x0 z0 x1 z1
+//        x0 z0 x1 z1 are inclusive chunk column coordinates (block coordinate / CHUNK_SIZE)
+//
+// Output is byte identical for a given seed whatever the thread count: every chunk is a pure function
+// of the seed and its position, and RegionWriter lays the payloads out in slot order
+
+
+struct Options {
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int seed = 0;
+    bool seedSet = false;
+    bool mesh = false;
+    std::string outDir = ".";
+    int x0 = 0, z0 = 0, x1 = 0, z1 = 0; // chunk columns, inclusive
+};
+
+static bool parseArgs(int argc, char** argv, Options& options) {
+    std::vector<int> area;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::atoi(argv[++i]);
+            options.seedSet = true;
+        } else if (arg == "--mesh") {
+            options.mesh = true;
+        } else if (arg == "--out" && i + 1 < argc) {
+            options.outDir = argv[++i];
+        } else if (!arg.empty() && std::isdigit(static_cast<unsigned char>(arg[arg[0] == '-' && arg.size() > 1 ? 1 : 0]))) {
+            area.push_back(std::atoi(arg.c_str()));
+        } else {
+            return false;
+        }
+    }
+    if (area.size() != 4) {
+        return false;
+    }
+    options.x0 = std::min(area[0], area[2]);
+    options.x1 = std::max(area[0], area[2]);
+    options.z0 = std::min(area[1], area[3]);
+    options.z1 = std::max(area[1], area[3]);
+    return true;
+}
+
+// runs fn(i) for every i in [0, count) across 'threads' threads, in whatever order they get to it
+template<typename Fn>
+static void parallelFor(int threads, int count, Fn fn) {
+    std::atomic<int> next{0};
+    auto worker = [&]{
+        for (int i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; t++) {
+        workers.emplace_back(worker);
+    }
+    worker(); // the calling thread works too
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+}
+
+struct Totals {
+    long long chunks = 0;
+    long long faces = 0;
+    long long generatedChunks = 0; // includes the border ring generated only to mesh against
+    size_t bytes = 0;
+    int regions = 0;
+};
+
+// generates (and meshes) the columns of one region that fall inside the requested area
+static bool bakeRegion(World& world, const Options& options, glm::ivec2 region, Totals& totals) {
+    const int chunksPerColumn = world.Y_LIMIT * 2 + 1;
+    const int regionX = region.x * REGION_COLUMNS; // in chunk columns
+    const int regionZ = region.y * REGION_COLUMNS;
+
+    // columns of this region to store
+    int x0 = std::max(options.x0, regionX), x1 = std::min(options.x1, regionX + REGION_COLUMNS - 1);
+    int z0 = std::max(options.z0, regionZ), z1 = std::min(options.z1, regionZ + REGION_COLUMNS - 1);
+
+    // meshing needs the faces of the neighbouring columns, so a ring around them is generated but not stored
+    int ring = options.mesh ? 1 : 0;
+    int genX0 = x0 - ring, genZ0 = z0 - ring;
+    int genWidth = (x1 - x0 + 1) + 2 * ring;
+    int genDepth = (z1 - z0 + 1) + 2 * ring;
+
+    // Phase 1: generate every column, kept RLE encoded so a region plus its ring stays small in memory
+    std::vector<std::vector<u_int8_t>> encoded(static_cast<size_t>(genWidth) * genDepth * chunksPerColumn);
+    auto encodedAt = [&](int column, int chunkIndexY) -> std::vector<u_int8_t>& {
+        return encoded[static_cast<size_t>(column) * chunksPerColumn + chunkIndexY];
+    };
+
+    parallelFor(options.threads, genWidth * genDepth, [&](int column) {
+        int chunkX = (genX0 + column / genDepth) * CHUNK_SIZE;
+        int chunkZ = (genZ0 + column % genDepth) * CHUNK_SIZE;
+        auto chunk = std::make_unique<Chunk>();
+        for (int y = 0; y < chunksPerColumn; y++) {
+            *chunk = Chunk();
+            world.generateChunkBlocks(glm::ivec3(chunkX, (y - world.Y_LIMIT) * CHUNK_SIZE, chunkZ), *chunk);
+            encodeChunkBlocks(*chunk, encodedAt(column, y));
+        }
+    });
+
+    // Phase 2: mesh against the decoded neighbours and hand every stored chunk to the writer
+    RegionWriter writer(region, world.getNoiseSeed(), chunksPerColumn, options.mesh);
+    int width = x1 - x0 + 1, depth = z1 - z0 + 1;
+    std::atomic<long long> faceCount{0};
+
+    parallelFor(options.threads, width * depth, [&](int index) {
+        int gx = index / depth + ring, gz = index % depth + ring; // in the generated grid
+        int column = gx * genDepth + gz;
+
+        std::vector<Chunk> columnChunks;
+        std::vector<Chunk> sideChunks; // right, left, back, front columns in neighbourChunks order
+        std::vector<PackedFace> faces;
+        if (options.mesh) {
+            columnChunks.resize(chunksPerColumn);
+            sideChunks.resize(4 * chunksPerColumn);
+            const int sideColumns[4] = { column + genDepth, column - genDepth, column + 1, column - 1 };
+            for (int y = 0; y < chunksPerColumn; y++) {
+                decodeChunkBlocks(encodedAt(column, y).data(), encodedAt(column, y).size(), columnChunks[y]);
+                for (int side = 0; side < 4; side++) {
+                    const std::vector<u_int8_t>& data = encodedAt(sideColumns[side], y);
+                    decodeChunkBlocks(data.data(), data.size(), sideChunks[side * chunksPerColumn + y]);
+                }
+            }
+        }
+
+        int localX = x0 - regionX + index / depth;
+        int localZ = z0 - regionZ + index % depth;
+        for (int y = 0; y < chunksPerColumn; y++) {
+            faces.clear();
+            if (options.mesh) {
+                glm::ivec3 chunkCoord((x0 + index / depth) * CHUNK_SIZE, (y - world.Y_LIMIT) * CHUNK_SIZE, (z0 + index % depth) * CHUNK_SIZE);
+                const Chunk* neighbours[6] = {
+                    &sideChunks[0 * chunksPerColumn + y],                           // Right
+                    &sideChunks[1 * chunksPerColumn + y],                           // Left
+                    y + 1 < chunksPerColumn ? &columnChunks[y + 1] : nullptr,       // Top
+                    y > 0 ? &columnChunks[y - 1] : nullptr,                         // Bottom
+                    &sideChunks[2 * chunksPerColumn + y],                           // Back
+                    &sideChunks[3 * chunksPerColumn + y],                           // Front
+                };
+                world.buildChunkFaces(columnChunks[y], chunkCoord, neighbours, faces);
+                faceCount += faces.size();
+            }
+            // neighbouring columns may still be decoding this one when meshing, so it is only moved out without meshes
+            if (options.mesh) {
+                writer.setChunk(localX, y, localZ, encodedAt(column, y), faces);
+            } else {
+                writer.setChunk(localX, y, localZ, std::move(encodedAt(column, y)), faces);
+            }
+        }
+    });
+
+    size_t bytes = 0;
+    std::string path = (std::filesystem::path(options.outDir) / getRegionFileName(region)).string();
+    if (!writer.write(path, &bytes)) {
+        return false;
+    }
+
+    totals.chunks += static_cast<long long>(width) * depth * chunksPerColumn;
+    totals.generatedChunks += static_cast<long long>(genWidth) * genDepth * chunksPerColumn;
+    totals.faces += faceCount;
+    totals.bytes += bytes;
+    totals.regions++;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        std::cerr << "usage: pregen [--threads N] [--seed S] [--mesh] [--out DIR] x0 z0 x1 z1\n"
+                  << "       x0 z0 x1 z1 are inclusive chunk column coordinates (block coordinate / " << CHUNK_SIZE << ")" << std::endl;
+        return 1;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(options.outDir, error);
+    if (error) {
+        std::cerr << "Failed to create output directory " << options.outDir << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    auto world = std::make_unique<World>();
+    if (options.seedSet) {
+        world->setNoiseSeed(options.seed);
+    }
+    world->initGenerator();
+
+    glm::ivec2 firstRegion = getRegionCoord(options.x0 * CHUNK_SIZE, options.z0 * CHUNK_SIZE);
+    glm::ivec2 lastRegion = getRegionCoord(options.x1 * CHUNK_SIZE, options.z1 * CHUNK_SIZE);
+
+    Totals totals;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int rx = firstRegion.x; rx <= lastRegion.x; rx++) {
+        for (int rz = firstRegion.y; rz <= lastRegion.y; rz++) {
+            if (!bakeRegion(*world, options, glm::ivec2(rx, rz), totals)) {
+                return 1;
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    double rawBytes = static_cast<double>(totals.chunks) * CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+    std::cout << "seed:                " << world->getNoiseSeed() << " (generator version " << World::GENERATOR_VERSION << ")\n";
+    std::cout << "threads:             " << options.threads << "\n";
+    std::cout << "regions written:     " << totals.regions << " to " << options.outDir << "\n";
+    std::cout << "chunks stored:       " << totals.chunks << " (" << totals.generatedChunks << " generated)\n";
+    if (options.mesh) {
+        std::cout << "faces meshed:        " << totals.faces << "\n";
+    }
+    std::cout << "time:                " << seconds << " s\n";
+    std::cout << "throughput:          " << totals.chunks / seconds << " chunks/s, " << rawBytes / seconds / 1e6 << " Mblocks/s\n";
+    std::cout << "on disk:             " << totals.bytes / 1e6 << " MB, " << static_cast<double>(totals.bytes) / std::max(1LL, totals.chunks) << " bytes/chunk, "
+              << rawBytes / std::max<size_t>(1, totals.bytes) << "x smaller than raw blocks\n";
+    return 0;
+}